@@ -22,6 +22,14 @@ public class LockOnTarget : ModuleRules
 
 		//Lock On Target Unreal Insights preprocessor definition.
 		PublicDefinitions.Add("LOT_INSIGHTS = 0");
+
+		//Targets are referenced over the network by the compact IDs assigned by UTargetManager instead of the owner actors.
+		//Makes UTargetComponent replicated by default and changes the FTargetInfo wire format.
+		PublicDefinitions.Add("LOT_COMPACT_TARGET_IDS = 0");
+
+		//Lets the governor register AI instigators in the USignificanceManager.
+		//To enable, set it to 1, uncomment the SignificanceManager dependency below and enable the SignificanceManager plugin in the project.
+		PublicDefinitions.Add("LOT_SIGNIFICANCE_MANAGER = 0");
 			
 		PublicDependencyModuleNames.AddRange(
 			new string[]
@@ -40,6 +48,9 @@ public class LockOnTarget : ModuleRules
 				"UMG",
 				"Projects",
 				"NetCore",
+				"Landscape",
+				"AIModule",
+				//"SignificanceManager",
 			}
 			);
 	}
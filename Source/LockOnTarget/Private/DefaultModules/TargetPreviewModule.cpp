@@ -5,6 +5,7 @@
 #include "TargetComponent.h"
 #include "TargetHandlers/TargetHandlerBase.h"
 #include "LockOnTargetDefines.h"
+#include "LockOnTargetGovernor.h"
 
 #include "Components/WidgetComponent.h"
 #include "Engine/AssetManager.h"
@@ -17,9 +18,9 @@ UTargetPreviewModule::UTargetPreviewModule()
 	, Widget(nullptr)
 	, bIsPreviewActive(true)
 	, bWidgetIsInitialized(false)
+	, bWidgetIsCulled(false)
 	, UpdateTimer(0.f)
 {
-	//Do something.
 }
 
 void UTargetPreviewModule::Initialize(ULockOnTargetComponent* Instigator)
@@ -120,24 +121,44 @@ void UTargetPreviewModule::Update(float DeltaTime)
 	{
 		UpdateTimer += DeltaTime;
 
-		if (UpdateTimer > UpdateRate)
+		//The governor slows down the preview under the load.
+		const float ScaledUpdateRate = UpdateRate * ULockOnTargetGovernor::GetQualitySettings(GetWorld()).PreviewUpdateRateScale;
+
+		if (UpdateTimer > ScaledUpdateRate)
 		{
-			UpdateTimer -= UpdateRate;
+			UpdateTimer -= ScaledUpdateRate;
 			UpdateTargetPreview();
 		}
+
+		//Evaluated every frame to show the widget as soon as it comes back into view.
+		if (IsPreviewTargetValid())
+		{
+			UpdateCulling();
+		}
 	}
 }
 
+void UTargetPreviewModule::UpdateCulling()
+{
+	Culling.UpdateWidget(Widget, GetPlayerController(), bWidgetIsCulled);
+}
+
 void UTargetPreviewModule::UpdateTargetPreview()
 {
 	const ULockOnTargetComponent* const Owner = GetLockOnTargetComponent();
 
 	if (UTargetHandlerBase* const TargetHandler = Owner->GetTargetHandler())
 	{
-		const FTargetInfo Preview = TargetHandler->FindTarget();
+		const FTargetInfo Preview = TargetHandler->FindTargetWithProfile(EvaluationProfile);
 
 		if (Owner->IsTargetValid(Preview.TargetComponent))
 		{
+			//Lets the next lock reuse the result instead of running the same search again.
+			if (EvaluationProfile.IsFullAccuracy())
+			{
+				TargetHandler->CacheFindResult(Preview);
+			}
+
 			if (Preview != GetPreviewTarget())
 			{
 				StopTargetPreview(GetPreviewTarget());
@@ -169,6 +190,10 @@ void UTargetPreviewModule::BeginTargetPreview(const FTargetInfo& Target)
 		Widget->AttachToComponent(Target.TargetComponent->GetTrackedMeshComponent(), FAttachmentTransformRules::SnapToTargetNotIncludingScale, Target.Socket);
 		Widget->SetVisibility(true);
 		Widget->SetRelativeLocation(Target.TargetComponent->WidgetRelativeOffset);
+		bWidgetIsCulled = false;
+
+		//Prevents popping of the widget which is off-screen from the start.
+		UpdateCulling();
 	}
 }
 
@@ -182,6 +207,7 @@ void UTargetPreviewModule::StopTargetPreview(const FTargetInfo& Target)
 		{
 			Widget->SetVisibility(false);
 			Widget->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+			bWidgetIsCulled = false;
 		}
 	}
 }
@@ -3,6 +3,7 @@
 #include "DefaultModules/WidgetModule.h"
 #include "LockOnTargetComponent.h"
 #include "TargetComponent.h"
+#include "TargetManager.h"
 #include "LockOnTargetDefines.h"
 
 #include "Components/WidgetComponent.h"
@@ -12,9 +13,14 @@
 
 UWidgetModule::UWidgetModule()
 	: DefaultWidgetClass(FSoftClassPath(FString(TEXT("/Script/UMGEditor.WidgetBlueprint'/LockOnTarget/WBP_Target.WBP_Target_C'"))))
+	, PrefetchRadius(3000.f)
+	, PrefetchInterval(0.5f)
 	, Widget(nullptr)
 	, bWidgetIsActive(false)
 	, bWidgetIsInitialized(false)
+	, bWidgetIsCulled(false)
+	, bWidgetIsHiddenManually(false)
+	, PrefetchTimer(0.f)
 {
 	//Do something.
 }
@@ -48,6 +54,8 @@ void UWidgetModule::Deinitialize(ULockOnTargetComponent* Instigator)
 		StreamableHandle.Reset();
 	}
 
+	ReleaseAllPrefetches();
+
 	Super::Deinitialize(Instigator);
 }
 
@@ -67,6 +75,11 @@ void UWidgetModule::OnTargetLocked(UTargetComponent* Target, FName Socket)
 		Widget->SetRelativeLocation(Target->WidgetRelativeOffset);
 		SetWidgetClass(Target->CustomWidgetClass.IsNull() ? DefaultWidgetClass : Target->CustomWidgetClass);
 		bWidgetIsActive = true;
+		bWidgetIsCulled = false;
+		bWidgetIsHiddenManually = false;
+
+		//Prevents popping of the widget which is off-screen from the start.
+		UpdateCulling();
 	}
 }
 
@@ -79,6 +92,7 @@ void UWidgetModule::OnTargetUnlocked(UTargetComponent* UnlockedTarget, FName Soc
 		Widget->SetVisibility(false);
 		Widget->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
 		bWidgetIsActive = false;
+		bWidgetIsCulled = false;
 	}
 }
 
@@ -122,6 +136,125 @@ void UWidgetModule::OnWidgetClassLoaded()
 	}
 }
 
+/*******************************************************************************************/
+/*******************************  Culling  *************************************************/
+/*******************************************************************************************/
+
+void UWidgetModule::UpdateCulling()
+{
+	Culling.UpdateWidget(Widget, GetPlayerController(), bWidgetIsCulled, bWidgetIsHiddenManually);
+}
+
+/*******************************************************************************************/
+/*******************************  Prefetch  ************************************************/
+/*******************************************************************************************/
+
+void UWidgetModule::Update(float DeltaTime)
+{
+	Super::Update(DeltaTime);
+
+	//Evaluated every frame to show the widget as soon as it comes back into view.
+	if (IsWidgetInitialized() && IsWidgetActive())
+	{
+		UpdateCulling();
+	}
+
+	if (PrefetchRadius > 0.f && GetController() && GetController()->IsLocalController())
+	{
+		PrefetchTimer += DeltaTime;
+
+		if (PrefetchTimer > PrefetchInterval)
+		{
+			PrefetchTimer = 0.f;
+			UpdatePrefetch();
+		}
+	}
+}
+
+void UWidgetModule::UpdatePrefetch()
+{
+	LOT_SCOPED_EVENT(WidgetModuleUpdatePrefetch, Blue);
+
+	const AActor* const Owner = GetLockOnTargetComponent()->GetOwner();
+
+	if (!Owner || !GetWorld())
+	{
+		return;
+	}
+
+	const FVector OwnerLocation = Owner->GetActorLocation();
+
+	//Release Targets which have left the radius or have been removed.
+	for (auto It = PrefetchingTargets.CreateIterator(); It; ++It)
+	{
+		const UTargetComponent* const Target = It.Key().Get();
+
+		if (!IsValid(Target) || Target->CustomWidgetClass.ToSoftObjectPath() != It.Value()
+			|| FVector::DistSquared(Target->GetOwner()->GetActorLocation(), OwnerLocation) > FMath::Square(PrefetchRadius))
+		{
+			ReleasePrefetchReference(It.Value());
+			It.RemoveCurrent();
+		}
+	}
+
+	//Add Targets which have entered the radius.
+	for (UTargetComponent* const Target : UTargetManager::Get(*GetWorld()).GetTargetsView())
+	{
+		if (Target->bWantsDisplayWidget && !Target->CustomWidgetClass.IsNull() && !PrefetchingTargets.Contains(Target)
+			&& FVector::DistSquared(Target->GetOwner()->GetActorLocation(), OwnerLocation) <= FMath::Square(PrefetchRadius))
+		{
+			const FSoftObjectPath WidgetClassPath = Target->CustomWidgetClass.ToSoftObjectPath();
+			PrefetchingTargets.Add(Target, WidgetClassPath);
+			AddPrefetchReference(WidgetClassPath);
+		}
+	}
+}
+
+void UWidgetModule::AddPrefetchReference(const FSoftObjectPath& WidgetClass)
+{
+	FWidgetClassPrefetch& Prefetch = PrefetchedClasses.FindOrAdd(WidgetClass);
+
+	if (Prefetch.RefCount++ == 0)
+	{
+		Prefetch.Handle = UAssetManager::Get().GetStreamableManager().RequestAsyncLoad(WidgetClass);
+	}
+}
+
+void UWidgetModule::ReleasePrefetchReference(const FSoftObjectPath& WidgetClass)
+{
+	if (FWidgetClassPrefetch* const Prefetch = PrefetchedClasses.Find(WidgetClass))
+	{
+		if (--Prefetch->RefCount <= 0)
+		{
+			if (Prefetch->Handle.IsValid())
+			{
+				Prefetch->Handle->ReleaseHandle();
+			}
+
+			PrefetchedClasses.Remove(WidgetClass);
+		}
+	}
+}
+
+void UWidgetModule::ReleaseAllPrefetches()
+{
+	for (auto& [WidgetClass, Prefetch] : PrefetchedClasses)
+	{
+		if (Prefetch.Handle.IsValid())
+		{
+			Prefetch.Handle->ReleaseHandle();
+		}
+	}
+
+	PrefetchedClasses.Reset();
+	PrefetchingTargets.Reset();
+	PrefetchTimer = 0.f;
+}
+
+/*******************************************************************************************/
+/*******************************  Polls  ***************************************************/
+/*******************************************************************************************/
+
 bool UWidgetModule::IsWidgetInitialized() const
 {
 	return bWidgetIsInitialized && ensureMsgf(IsValid(Widget), TEXT("Widget was initialized but is invalid. Maybe it was removed manually."));
@@ -141,7 +274,8 @@ void UWidgetModule::SetWidgetVisibility(bool bInVisibility)
 {
 	if (IsWidgetInitialized())
 	{
-		//We can only show widget when it's active, though we can whenever hide it.
-		Widget->SetVisibility(bInVisibility && IsWidgetActive());
+		//We can only show widget when it's active and not culled, though we can whenever hide it.
+		bWidgetIsHiddenManually = !bInVisibility;
+		Widget->SetVisibility(bInVisibility && IsWidgetActive() && !bWidgetIsCulled);
 	}
 }
@@ -0,0 +1,282 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "LandscapeOcclusionSubsystem.h"
+#include "LockOnTargetDefines.h"
+
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "LandscapeProxy.h"
+#include "Engine/Level.h"
+
+ULandscapeOcclusionSubsystem::ULandscapeOcclusionSubsystem()
+	: CellSize(400.f)
+	, MaxCellsPerRay(256)
+	, MaxCachedSamples(65536)
+	, bLandscapesGathered(false)
+{
+	//Do something.
+}
+
+ULandscapeOcclusionSubsystem* ULandscapeOcclusionSubsystem::Get(const UWorld* InWorld)
+{
+	return InWorld ? InWorld->GetSubsystem<ThisClass>() : nullptr;
+}
+
+void ULandscapeOcclusionSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &ThisClass::OnLevelChanged);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &ThisClass::OnLevelChanged);
+}
+
+void ULandscapeOcclusionSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+	Invalidate();
+
+	Super::Deinitialize();
+}
+
+bool ULandscapeOcclusionSubsystem::DoesSupportWorldType(const EWorldType::Type Type) const
+{
+	return Type == EWorldType::Game || Type == EWorldType::PIE;
+}
+
+void ULandscapeOcclusionSubsystem::OnLevelChanged(ULevel* InLevel, UWorld* InWorld)
+{
+	if (InWorld != GetWorld() || !InLevel)
+	{
+		return;
+	}
+
+	//Streamed levels may add or remove landscape proxies. Only the cells under them are resampled.
+	FBox2D ChangedBounds(ForceInit);
+
+	for (const AActor* const Actor : InLevel->Actors)
+	{
+		if (const ALandscapeProxy* const Proxy = Cast<ALandscapeProxy>(Actor))
+		{
+			const FBox Bounds = Proxy->GetComponentsBoundingBox();
+
+			if (Bounds.IsValid)
+			{
+				ChangedBounds += FBox2D(FVector2D(Bounds.Min), FVector2D(Bounds.Max));
+			}
+		}
+	}
+
+	if (ChangedBounds.bIsValid)
+	{
+		//Gathering is cheap compared to the sampling.
+		bLandscapesGathered = false;
+		InvalidateCells(ChangedBounds);
+	}
+}
+
+void ULandscapeOcclusionSubsystem::Invalidate()
+{
+	Landscapes.Reset();
+	CellMinHeights.Reset();
+	bLandscapesGathered = false;
+}
+
+void ULandscapeOcclusionSubsystem::InvalidateCells(const FBox2D& Bounds)
+{
+	const FIntPoint MinCell(FMath::FloorToInt32(Bounds.Min.X / CellSize), FMath::FloorToInt32(Bounds.Min.Y / CellSize));
+	const FIntPoint MaxCell(FMath::FloorToInt32(Bounds.Max.X / CellSize), FMath::FloorToInt32(Bounds.Max.Y / CellSize));
+
+	for (auto It = CellMinHeights.CreateIterator(); It; ++It)
+	{
+		const FIntPoint& Cell = It->Key;
+
+		if (Cell.X >= MinCell.X && Cell.X <= MaxCell.X && Cell.Y >= MinCell.Y && Cell.Y <= MaxCell.Y)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void ULandscapeOcclusionSubsystem::GatherLandscapes()
+{
+	LOT_SCOPED_EVENT(LandscapeOcclusionGather, Blue);
+
+	Landscapes.Reset();
+
+	for (TActorIterator<ALandscapeProxy> It(GetWorld()); It; ++It)
+	{
+		const FBox Bounds = It->GetComponentsBoundingBox();
+
+		if (Bounds.IsValid)
+		{
+			Landscapes.Add({ *It, FBox2D(FVector2D(Bounds.Min), FVector2D(Bounds.Max)) });
+		}
+	}
+
+	bLandscapesGathered = true;
+}
+
+float ULandscapeOcclusionSubsystem::GetCellMinHeight(int32 CellX, int32 CellY)
+{
+	const FIntPoint Cell(CellX, CellY);
+
+	if (const float* const CachedHeight = CellMinHeights.Find(Cell))
+	{
+		return *CachedHeight;
+	}
+
+	if (CellMinHeights.Num() >= MaxCachedSamples)
+	{
+		CellMinHeights.Reset();
+	}
+
+	const FVector2D CellMin = FVector2D(Cell) * CellSize;
+	const float MinHeight = SampleCellMinHeight(FBox2D(CellMin, CellMin + CellSize));
+
+	CellMinHeights.Add(Cell, MinHeight);
+	return MinHeight;
+}
+
+float ULandscapeOcclusionSubsystem::SampleCellMinHeight(const FBox2D& CellBounds) const
+{
+	LOT_SCOPED_EVENT(LandscapeOcclusionSampleCell, Blue);
+
+	//Landscape proxies share the border vertices.
+	auto IsInsideOrOn = [](const FBox2D& Box, const FVector2D& Point)
+	{
+		return Point.X >= Box.Min.X && Point.X <= Box.Max.X && Point.Y >= Box.Min.Y && Point.Y <= Box.Max.Y;
+	};
+
+	//A partially covered cell disables the test for it.
+	const FVector2D Corners[] = { CellBounds.Min, { CellBounds.Max.X, CellBounds.Min.Y }, { CellBounds.Min.X, CellBounds.Max.Y }, CellBounds.Max };
+
+	for (const FVector2D& Corner : Corners)
+	{
+		if (!Landscapes.ContainsByPredicate([&Corner, &IsInsideOrOn](const FLandscapeEntry& Entry) { return Entry.Proxy.IsValid() && IsInsideOrOn(Entry.Bounds, Corner); }))
+		{
+			return TNumericLimits<float>::Lowest();
+		}
+	}
+
+	float MinHeight = TNumericLimits<float>::Max();
+
+	for (const FLandscapeEntry& Entry : Landscapes)
+	{
+		const ALandscapeProxy* const Proxy = Entry.Proxy.Get();
+
+		if (!Proxy || !Entry.Bounds.Intersect(CellBounds))
+		{
+			continue;
+		}
+
+		//The collision heightfield is piecewise linear between its vertices, so the terrain inside the cell can't be lower
+		//than the lowest vertex of the triangles overlapping the cell. Every landscape vertex around the cell is sampled,
+		//expanded by one collision quad, which may span several vertices with the collision mip.
+		const FTransform& LandscapeTransform = Proxy->GetTransform();
+		FBox2D LocalBounds(ForceInit);
+
+		for (const FVector2D& Corner : Corners)
+		{
+			LocalBounds += FVector2D(LandscapeTransform.InverseTransformPosition(FVector(Corner, 0.f)));
+		}
+
+		const int32 CollisionQuad = 1 << FMath::Clamp(Proxy->CollisionMipLevel, 0, 5);
+		const FIntPoint MinVertex(FMath::FloorToInt32(LocalBounds.Min.X) - CollisionQuad, FMath::FloorToInt32(LocalBounds.Min.Y) - CollisionQuad);
+		const FIntPoint MaxVertex(FMath::CeilToInt32(LocalBounds.Max.X) + CollisionQuad, FMath::CeilToInt32(LocalBounds.Max.Y) + CollisionQuad);
+
+		for (int32 Y = MinVertex.Y; Y <= MaxVertex.Y; ++Y)
+		{
+			for (int32 X = MinVertex.X; X <= MaxVertex.X; ++X)
+			{
+				const FVector VertexLocation = LandscapeTransform.TransformPosition(FVector(X, Y, 0.f));
+
+				//Vertices past the proxy edge belong to a neighbor, which samples them itself.
+				if (!IsInsideOrOn(Entry.Bounds, FVector2D(VertexLocation)))
+				{
+					continue;
+				}
+
+				const TOptional<float> SampledHeight = Proxy->GetHeightAtLocation(VertexLocation);
+
+				if (!SampledHeight.IsSet())
+				{
+					//A hole, the terrain can't be trusted here.
+					return TNumericLimits<float>::Lowest();
+				}
+
+				MinHeight = FMath::Min(MinHeight, SampledHeight.GetValue());
+			}
+		}
+	}
+
+	return MinHeight == TNumericLimits<float>::Max() ? TNumericLimits<float>::Lowest() : MinHeight;
+}
+
+bool ULandscapeOcclusionSubsystem::IsRayOccluded(const FVector& From, const FVector& To, float Tolerance)
+{
+	LOT_SCOPED_EVENT(LandscapeOcclusionRay, Yellow);
+
+	if (!bLandscapesGathered)
+	{
+		GatherLandscapes();
+	}
+
+	if (Landscapes.IsEmpty() || CellSize <= 0.f)
+	{
+		return false;
+	}
+
+	const FVector Delta = To - From;
+	const FVector2D Start2D = FVector2D(From) / CellSize;
+	const FVector2D Delta2D = FVector2D(Delta) / CellSize;
+
+	int32 CellX = FMath::FloorToInt32(Start2D.X);
+	int32 CellY = FMath::FloorToInt32(Start2D.Y);
+	const int32 EndCellX = FMath::FloorToInt32(Start2D.X + Delta2D.X);
+	const int32 EndCellY = FMath::FloorToInt32(Start2D.Y + Delta2D.Y);
+
+	const int32 StepX = Delta2D.X > 0.f ? 1 : -1;
+	const int32 StepY = Delta2D.Y > 0.f ? 1 : -1;
+
+	//Ray parameter (0..1) needed to cross one cell and to reach the next cell border on each axis.
+	const float DeltaTX = FMath::IsNearlyZero(Delta2D.X) ? BIG_NUMBER : FMath::Abs(1.f / Delta2D.X);
+	const float DeltaTY = FMath::IsNearlyZero(Delta2D.Y) ? BIG_NUMBER : FMath::Abs(1.f / Delta2D.Y);
+	float NextTX = FMath::IsNearlyZero(Delta2D.X) ? BIG_NUMBER : ((StepX > 0 ? CellX + 1 - Start2D.X : Start2D.X - CellX) * DeltaTX);
+	float NextTY = FMath::IsNearlyZero(Delta2D.Y) ? BIG_NUMBER : ((StepY > 0 ? CellY + 1 - Start2D.Y : Start2D.Y - CellY) * DeltaTY);
+
+	float EnterT = 0.f;
+
+	for (int32 Steps = 0; Steps < MaxCellsPerRay; ++Steps)
+	{
+		const float ExitT = FMath::Min3(NextTX, NextTY, 1.f);
+
+		//The highest point of the ray inside the cell must be under the lowest terrain point.
+		const float RayMaxHeight = From.Z + Delta.Z * (Delta.Z > 0.f ? ExitT : EnterT);
+
+		if (RayMaxHeight < GetCellMinHeight(CellX, CellY) - Tolerance)
+		{
+			return true;
+		}
+
+		if (ExitT >= 1.f || (CellX == EndCellX && CellY == EndCellY))
+		{
+			break;
+		}
+
+		EnterT = ExitT;
+
+		if (NextTX < NextTY)
+		{
+			CellX += StepX;
+			NextTX += DeltaTX;
+		}
+		else
+		{
+			CellY += StepY;
+			NextTY += DeltaTY;
+		}
+	}
+
+	return false;
+}
@@ -2,29 +2,48 @@
 
 #include "LockOnTargetComponent.h"
 #include "TargetComponent.h"
+#include "TargetManager.h"
 #include "TargetHandlers/TargetHandlerBase.h"
 #include "LockOnTargetDefines.h"
 #include "LockOnTargetModuleBase.h"
+#include "LockOnTargetGovernor.h"
+#include "LockOnTargetTickManager.h"
+#include "LockOnTargetTrace.h"
 
 #include "Net/UnrealNetwork.h"
 #include "TimerManager.h"
+#include "Misc/ScopeRWLock.h"
 #include "Engine/Engine.h"
 #include "Engine/World.h"
+#include "Engine/DemoNetDriver.h"
 
 ULockOnTargetComponent::ULockOnTargetComponent()
 	: bCanCaptureTarget(true)
+	, bUseAggregatedTick(false)
+	, bPublishSnapshot(false)
 	, InputBufferThreshold(.15f)
 	, BufferResetFrequency(.2f)
 	, ClampInputVector(-2.f, 2.f)
 	, InputProcessingDelay(0.25f)
 	, bFreezeInputAfterSwitch(true)
 	, UnfreezeThreshold(1e-2f)
+	, bProcessInputOnEvent(false)
+	, MaxInputEventInterval(0.1f)
 	, CurrentTargetInternal(FTargetInfo::NULL_TARGET)
 	, TargetingDuration(0.f)
 	, bIsTargetLocked(false)
+	, bTargetUpdateDeferred(false)
+	, bIsTickAggregated(false)
+	, AppliedTargetInfo(FTargetInfo::NULL_TARGET)
+	, bSnapshotRequested(false)
+	, SignificanceLevel(INDEX_NONE)
+	, LastSearchTime(-UE_BIG_NUMBER)
+	, ModulesUpdateTime(0.f)
 	, bInputFrozen(false)
 	, InputBuffer(0.f)
 	, InputVector(0.f)
+	, YawInputTime(0.0)
+	, PitchInputTime(0.0)
 {
 	PrimaryComponentTick.bCanEverTick = true;
 	PrimaryComponentTick.bStartWithTickEnabled = true;
@@ -66,12 +85,55 @@ void ULockOnTargetComponent::InitializeComponent()
 	}
 }
 
+void ULockOnTargetComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (bPublishSnapshot)
+	{
+		bSnapshotRequested.store(true, std::memory_order_relaxed);
+	}
+
+	//The aggregated tick bypasses TickComponent(), so the Blueprint tick would never fire.
+	if (bUseAggregatedTick && GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(ULockOnTargetComponent, ReceiveTick)))
+	{
+		LOG_WARNING("%s implements the Blueprint tick and isn't ticked by LockOnTargetTickManager.", *GetNameSafe(GetClass()));
+	}
+	else if (bUseAggregatedTick)
+	{
+		if (ULockOnTargetTickManager* const TickManager = ULockOnTargetTickManager::Get(GetWorld()))
+		{
+			bIsTickAggregated = true;
+			SetComponentTickEnabled(false);
+			TickManager->RegisterComponent(this);
+		}
+	}
+
+	if (ULockOnTargetGovernor* const Governor = ULockOnTargetGovernor::Get(GetWorld()))
+	{
+		Governor->RegisterInstigator(this);
+	}
+}
+
 void ULockOnTargetComponent::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
+	if (ULockOnTargetTickManager* const TickManager = bIsTickAggregated ? ULockOnTargetTickManager::Get(GetWorld()) : nullptr)
+	{
+		TickManager->UnregisterComponent(this);
+	}
+
+	bIsTickAggregated = false;
+
+	if (ULockOnTargetGovernor* const Governor = ULockOnTargetGovernor::Get(GetWorld()))
+	{
+		Governor->UnregisterInstigator(this);
+	}
+
 	bCanCaptureTarget = false;
-	OnTargetReleased(CurrentTargetInternal);
+	OnTargetReleased(GetAppliedTarget());
+	bTargetUpdateDeferred = false;
 
 	ClearTargetHandler();
 	RemoveAllModules();
@@ -82,6 +144,12 @@ void ULockOnTargetComponent::EndPlay(EEndPlayReason::Type EndPlayReason)
 	}
 }
 
+void ULockOnTargetComponent::SetComponentTickEnabled(bool bEnabled)
+{
+	//The own tick stays disabled while the aggregated one is used, e.g. on Activate().
+	Super::SetComponentTickEnabled(bEnabled && !bIsTickAggregated);
+}
+
 void ULockOnTargetComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
@@ -93,6 +161,10 @@ void ULockOnTargetComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty
 	FDoRepLifetimeParams Params;
 	Params.bIsPushBased = true; //Can be activated in DefaultEngine.ini
 	Params.Condition = COND_SkipOwner; //Local authority.
+#if LOT_COMPACT_TARGET_IDS
+	//Unresolved Targets are all equal to the null one, so the received ID has to be notified anyway.
+	Params.RepNotifyCondition = REPNOTIFY_Always;
+#endif
 	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, CurrentTargetInternal, Params);
 
 	//We need to initially synchronize the timer for unmapped simulated proxies. It's not accurate, but does it make sense?
@@ -118,13 +190,48 @@ FVector ULockOnTargetComponent::GetCapturedFocusLocation() const
 	return IsTargetLocked() ? GetTargetComponent()->GetFocusLocation(this) : FVector(0.f);
 }
 
+FLockOnTargetSnapshot ULockOnTargetComponent::GetSnapshot() const
+{
+	bSnapshotRequested.store(true, std::memory_order_relaxed);
+
+	FReadScopeLock ReadLock(SnapshotLock);
+	return Snapshot;
+}
+
+void ULockOnTargetComponent::PublishSnapshot()
+{
+	//GetCapturedFocusLocation() may be overridden by the Target, so nothing is evaluated until someone reads the snapshot.
+	if (!bSnapshotRequested.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	FLockOnTargetSnapshot NewSnapshot;
+
+	if (IsTargetLocked())
+	{
+		NewSnapshot.bIsTargetLocked = true;
+		NewSnapshot.TargetActor = GetTargetActor();
+		NewSnapshot.Socket = GetCapturedSocket();
+		NewSnapshot.FocusLocation = GetCapturedFocusLocation();
+		NewSnapshot.TargetingDuration = GetTargetingDuration();
+
+		const FVector Direction = NewSnapshot.FocusLocation - GetOwner()->GetActorLocation();
+		NewSnapshot.DistanceToTarget = Direction.Size();
+		NewSnapshot.DirectionToTarget = Direction.GetSafeNormal();
+	}
+
+	FWriteScopeLock WriteLock(SnapshotLock);
+	Snapshot = NewSnapshot;
+}
+
 /*******************************************************************************************/
 /********************************  Target Validation  **************************************/
 /*******************************************************************************************/
 
 bool ULockOnTargetComponent::CanTargetBeCaptured(const FTargetInfo& TargetInfo) const
 {
-	return IsTargetValid(TargetInfo.TargetComponent) && (!IsTargetLocked() || TargetInfo != CurrentTargetInternal);
+	return IsTargetValid(TargetInfo.TargetComponent) && (!IsTargetLocked() || TargetInfo != GetAppliedTarget());
 }
 
 bool ULockOnTargetComponent::IsTargetValid(const UTargetComponent* Target) const
@@ -158,12 +265,31 @@ void ULockOnTargetComponent::TryFindTarget(FVector2D OptionalInput)
 {
 	LOT_BOOKMARK("PerformFindTarget");
 	LOT_SCOPED_EVENT(TryFindTarget, Green);
+	const ULockOnTargetGovernor::FCostScope CostScope(ULockOnTargetGovernor::Get(GetWorld()));
 
 	checkf(HasAuthorityOverTarget(), TEXT("Only the locally controlled owners are able to find a Target."));
 
+	//The search is skipped if the significance LOD has run out of searches.
+	if (!ConsumeSearchAllowance())
+	{
+		return;
+	}
+
 	if (IsValid(GetTargetHandler()))
 	{
-		const FTargetInfo NewTargetInfo = GetTargetHandler()->FindTarget(OptionalInput);
+		FTargetInfo NewTargetInfo = FTargetInfo::NULL_TARGET;
+
+		//The Find result may have been computed recently, e.g. by TargetPreviewModule.
+		if (!IsTargetLocked() && OptionalInput.IsZero())
+		{
+			NewTargetInfo = GetTargetHandler()->ConsumeCachedFindResult();
+		}
+
+		if (NewTargetInfo == FTargetInfo::NULL_TARGET)
+		{
+			NewTargetInfo = GetTargetHandler()->FindTarget(OptionalInput);
+		}
+
 		ProcessTargetHandlerResult(NewTargetInfo);
 	}
 	else
@@ -229,6 +355,25 @@ bool ULockOnTargetComponent::HasAuthorityOverTarget() const
 	return false;
 }
 
+bool ULockOnTargetComponent::ConsumeSearchAllowance()
+{
+	const float MaxSearchesPerSecond = ULockOnTargetGovernor::GetSignificanceSettings(this).MaxSearchesPerSecond;
+
+	if (MaxSearchesPerSecond > 0.f)
+	{
+		const double CurrentTime = GetWorld()->GetTimeSeconds();
+
+		if (CurrentTime - LastSearchTime < 1.0 / MaxSearchesPerSecond)
+		{
+			return false;
+		}
+
+		LastSearchTime = CurrentTime;
+	}
+
+	return true;
+}
+
 bool ULockOnTargetComponent::CanCaptureTarget() const
 {
 	return bCanCaptureTarget && HasBegunPlay() && HasAuthorityOverTarget();
@@ -301,10 +446,15 @@ void ULockOnTargetComponent::UpdateTargetInfo(const FTargetInfo& TargetInfo)
 
 void ULockOnTargetComponent::Server_UpdateTargetInfo_Implementation(const FTargetInfo& TargetInfo)
 {
-	if (TargetInfo != CurrentTargetInternal)
+	//IDs of the Targets destroyed in the meantime are resolved to the null Target.
+	FTargetInfo ResolvedInfo = TargetInfo;
+	ResolvedInfo.ResolveNetTarget(UTargetManager::Get(*GetWorld()));
+	ResolvedInfo.NetTargetId = 0;
+
+	if (ResolvedInfo != CurrentTargetInternal)
 	{
 		const FTargetInfo OldTarget = CurrentTargetInternal;
-		CurrentTargetInternal = TargetInfo;
+		CurrentTargetInternal = ResolvedInfo;
 		OnTargetInfoUpdated(OldTarget);
 		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, CurrentTargetInternal, this);
 	}
@@ -312,10 +462,91 @@ void ULockOnTargetComponent::Server_UpdateTargetInfo_Implementation(const FTarge
 
 bool ULockOnTargetComponent::Server_UpdateTargetInfo_Validate(const FTargetInfo& TargetInfo)
 {
-	return !TargetInfo.TargetComponent || CanTargetBeCaptured(TargetInfo);
+	FTargetInfo ResolvedInfo = TargetInfo;
+	ResolvedInfo.ResolveNetTarget(UTargetManager::Get(*GetWorld()));
+
+	return !ResolvedInfo.TargetComponent || CanTargetBeCaptured(ResolvedInfo);
+}
+
+bool ULockOnTargetComponent::ResolvePendingNetTarget()
+{
+	if (!CurrentTargetInternal.IsNetTargetPending())
+	{
+		return true;
+	}
+
+	const FTargetInfo OldTarget = CurrentTargetInternal;
+
+	if (!CurrentTargetInternal.ResolveNetTarget(UTargetManager::Get(*GetWorld())))
+	{
+		return false;
+	}
+
+	OnTargetInfoUpdated(OldTarget);
+	return true;
 }
 
 void ULockOnTargetComponent::OnTargetInfoUpdated(const FTargetInfo& OldTarget)
+{
+	//The received Target may not be known by the compact ID yet, then it's applied once mapped.
+	if (!CurrentTargetInternal.ResolveNetTarget(UTargetManager::Get(*GetWorld())))
+	{
+		UTargetManager::Get(*GetWorld()).AddPendingNetInstigator(this);
+	}
+
+	if (OldTarget == CurrentTargetInternal)
+	{
+		return;
+	}
+
+	if (IsReplayFastForwarding())
+	{
+		//Intermediate states are skipped within the frame, so only the first old Target is remembered.
+		if (!bTargetUpdateDeferred)
+		{
+			bTargetUpdateDeferred = true;
+			AppliedTargetInfo = OldTarget;
+		}
+
+		return;
+	}
+
+	if (bTargetUpdateDeferred)
+	{
+		FlushDeferredTargetUpdate();
+	}
+	else
+	{
+		ApplyTargetInfoUpdate(OldTarget);
+	}
+}
+
+void ULockOnTargetComponent::FlushDeferredTargetUpdate()
+{
+	if (bTargetUpdateDeferred && !IsReplayFastForwarding())
+	{
+		bTargetUpdateDeferred = false;
+
+		//The Target might have returned to the applied state.
+		if (AppliedTargetInfo != CurrentTargetInternal)
+		{
+			LOT_BOOKMARK("Replay Target update flushed");
+			ApplyTargetInfoUpdate(AppliedTargetInfo);
+		}
+
+		AppliedTargetInfo = FTargetInfo::NULL_TARGET;
+	}
+}
+
+bool ULockOnTargetComponent::IsReplayFastForwarding() const
+{
+	const UWorld* const World = GetWorld();
+	const UDemoNetDriver* const DemoNetDriver = World ? World->GetDemoNetDriver() : nullptr;
+
+	return DemoNetDriver && DemoNetDriver->IsFastForwarding();
+}
+
+void ULockOnTargetComponent::ApplyTargetInfoUpdate(const FTargetInfo& OldTarget)
 {
 	if (IsValid(CurrentTargetInternal.TargetComponent))
 	{
@@ -336,6 +567,9 @@ void ULockOnTargetComponent::OnTargetInfoUpdated(const FTargetInfo& OldTarget)
 		//Null Target.
 		OnTargetReleased(OldTarget);
 	}
+
+	//The lock state is visible to the other threads before the next tick.
+	PublishSnapshot();
 }
 
 void ULockOnTargetComponent::OnTargetCaptured(const FTargetInfo& Target)
@@ -343,6 +577,7 @@ void ULockOnTargetComponent::OnTargetCaptured(const FTargetInfo& Target)
 	check(Target.TargetComponent);
 
 	LOT_BOOKMARK("Target captured %s", *GetNameSafe(Target.TargetComponent->GetOwner()));
+	LOT_TRACE_TARGET_EVENT(this, Locked, Target.TargetComponent, Target.Socket);
 
 	bIsTargetLocked = true;
 	Target.TargetComponent->CaptureTarget(this);
@@ -362,6 +597,7 @@ void ULockOnTargetComponent::OnTargetReleased(const FTargetInfo& Target)
 		check(Target.TargetComponent);
 
 		LOT_BOOKMARK("Target released %s", *GetNameSafe(Target.TargetComponent->GetOwner()));
+		LOT_TRACE_TARGET_EVENT(this, Unlocked, Target.TargetComponent, Target.Socket);
 
 		bIsTargetLocked = false;
 		Target.TargetComponent->ReleaseTarget(this);
@@ -381,6 +617,7 @@ void ULockOnTargetComponent::OnTargetReleased(const FTargetInfo& Target)
 void ULockOnTargetComponent::OnTargetSocketChanged(FName OldSocket)
 {
 	LOT_BOOKMARK("SocketChanged %s->%s", *OldSocket.ToString(), *GetCapturedSocket().ToString());
+	LOT_TRACE_TARGET_EVENT(this, SocketChanged, GetTargetComponent(), GetCapturedSocket());
 
 	ForEachSubobject([this, OldSocket](ULockOnTargetModuleProxy* Module)
 		{
@@ -392,6 +629,15 @@ void ULockOnTargetComponent::OnTargetSocketChanged(FName OldSocket)
 
 void ULockOnTargetComponent::ReceiveTargetException(ETargetExceptionType Exception)
 {
+	//Only the applied Target knows about this component, so it's the one that raised the exception.
+	//The replicated Target is left as is and will be applied when the playback resumes.
+	if (bTargetUpdateDeferred)
+	{
+		OnTargetReleased(AppliedTargetInfo);
+		AppliedTargetInfo = FTargetInfo::NULL_TARGET;
+		return;
+	}
+
 	const FTargetInfo Target = CurrentTargetInternal;
 
 	//Clear Target locally.
@@ -424,6 +670,15 @@ void ULockOnTargetComponent::TickComponent(float DeltaTime, ELevelTick TickType,
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
 	LOT_SCOPED_EVENT(Tick, Red);
+	const ULockOnTargetGovernor::FCostScope CostScope(ULockOnTargetGovernor::Get(GetWorld()));
+
+	TickTargeting(DeltaTime);
+	TickModules(DeltaTime);
+}
+
+void ULockOnTargetComponent::TickTargeting(float DeltaTime)
+{
+	FlushDeferredTargetUpdate();
 
 	if (IsTargetLocked())
 	{
@@ -431,15 +686,38 @@ void ULockOnTargetComponent::TickComponent(float DeltaTime, ELevelTick TickType,
 
 		if(HasAuthorityOverTarget())
 		{
-			ProcessAnalogInput(DeltaTime);
+			if (!bProcessInputOnEvent)
+			{
+				ProcessAnalogInput(DeltaTime);
+			}
+			else
+			{
+				ReleaseIdleInput();
+			}
+
 			CheckTargetState(DeltaTime);
 		}
 	}
+}
 
-	ForEachSubobject([DeltaTime](ULockOnTargetModuleProxy* Module)
-		{
-			Module->Update(DeltaTime);
-		});
+void ULockOnTargetComponent::TickModules(float DeltaTime)
+{
+	//Insignificant AI instigators update the modules less often.
+	ModulesUpdateTime += DeltaTime;
+
+	if (ModulesUpdateTime >= ULockOnTargetGovernor::GetSignificanceSettings(this).ModuleTickInterval)
+	{
+		const float ModulesDeltaTime = ModulesUpdateTime;
+		ModulesUpdateTime = 0.f;
+
+		ForEachSubobject([ModulesDeltaTime](ULockOnTargetModuleProxy* Module)
+			{
+				Module->Update(ModulesDeltaTime);
+			});
+	}
+
+	//The last step of both the own and the aggregated tick.
+	PublishSnapshot();
 }
 
 /*******************************************************************************************/
@@ -561,12 +839,26 @@ void ULockOnTargetComponent::RemoveAllModules()
 
 void ULockOnTargetComponent::SwitchTargetYaw(float YawAxis)
 {
-	InputVector.X = YawAxis;
+	if (bProcessInputOnEvent)
+	{
+		ProcessInputEvent(YawAxis, YawInputTime, PitchInputTime, true);
+	}
+	else
+	{
+		InputVector.X = YawAxis;
+	}
 }
 
 void ULockOnTargetComponent::SwitchTargetPitch(float PitchAxis)
 {
-	InputVector.Y = PitchAxis;
+	if (bProcessInputOnEvent)
+	{
+		ProcessInputEvent(PitchAxis, PitchInputTime, YawInputTime, false);
+	}
+	else
+	{
+		InputVector.Y = PitchAxis;
+	}
 }
 
 bool ULockOnTargetComponent::IsInputDelayActive() const
@@ -592,13 +884,60 @@ void ULockOnTargetComponent::ProcessAnalogInput(float DeltaTime)
 	//@TODO: If the Target is unlocked while the Input is frozen, then it'll be frozen until the new Target is captured.
 
 	const FVector2D ConsumedInput = ConsumeInput();
+	AccumulateInput(ConsumedInput, ConsumedInput.ClampAxes(ClampInputVector.X, ClampInputVector.Y) * DeltaTime);
+}
 
-	if (IsInputDelayActive() || !CanInputBeProcessed(ConsumedInput))
+void ULockOnTargetComponent::ProcessInputEvent(float Axis, double& AxisInputTime, double OtherAxisInputTime, bool bYaw)
+{
+	LOT_SCOPED_EVENT(ProcessInputEvent, Blue);
+
+	//The game time, so the threshold is reached the same as in the tick processing, incl. the time dilation.
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	//The first event after a pause is integrated over the frame, as the tick processing does.
+	const bool bAxisWasReleased = Now - AxisInputTime > MaxInputEventInterval;
+	const float EventDeltaTime = bAxisWasReleased ? GetWorld()->GetDeltaSeconds() : Now - AxisInputTime;
+	AxisInputTime = Now;
+
+	//The other axis keeps its last value until it's considered released.
+	double& AxisValue = bYaw ? InputVector.X : InputVector.Y;
+	double& OtherAxisValue = bYaw ? InputVector.Y : InputVector.X;
+	AxisValue = Axis;
+
+	if (Now - OtherAxisInputTime > MaxInputEventInterval)
+	{
+		OtherAxisValue = 0.f;
+	}
+
+	if (!IsTargetLocked() || !HasAuthorityOverTarget())
+	{
+		return;
+	}
+
+	const float ClampedAxis = FMath::Clamp<float>(Axis, ClampInputVector.X, ClampInputVector.Y);
+	AccumulateInput(InputVector, (bYaw ? FVector2D(ClampedAxis, 0.f) : FVector2D(0.f, ClampedAxis)) * EventDeltaTime);
+}
+
+void ULockOnTargetComponent::ReleaseIdleInput()
+{
+	//Input sources may only send non-zero events, so the silence of both axes is treated as the release.
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	if (Now - YawInputTime > MaxInputEventInterval && Now - PitchInputTime > MaxInputEventInterval)
+	{
+		InputVector = FVector2D::ZeroVector;
+		bInputFrozen = false;
+	}
+}
+
+void ULockOnTargetComponent::AccumulateInput(FVector2D Input, FVector2D DeltaBuffer)
+{
+	if (IsInputDelayActive() || !CanInputBeProcessed(Input))
 	{
 		return;
 	}
 
-	InputBuffer += ConsumedInput.ClampAxes(ClampInputVector.X, ClampInputVector.Y) * DeltaTime;
+	InputBuffer += DeltaBuffer;
 
 	if (InputBuffer.SizeSquared() > FMath::Square(InputBufferThreshold))
 	{
@@ -0,0 +1,355 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "LockOnTargetGovernor.h"
+#include "LockOnTargetComponent.h"
+#include "LockOnTargetDefines.h"
+
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/PlatformTime.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "ProfilingDebugging/MiscTrace.h"
+
+#if LOT_SIGNIFICANCE_MANAGER
+#include "SignificanceManager.h"
+#endif
+
+CSV_DEFINE_CATEGORY(LockOnTarget, true);
+
+ULockOnTargetGovernor::ULockOnTargetGovernor()
+	: bEnabled(false)
+	, BudgetMs(0.5f)
+	, RestoreBudgetRatio(0.5f)
+	, FramesToDegrade(10)
+	, FramesToRestore(120)
+	, Quality(ELockOnTargetQuality::High)
+	, FrameCostSeconds(0.0)
+	, AverageCostMs(0.f)
+	, OverBudgetFrames(0)
+	, UnderBudgetFrames(0)
+	, ScopeDepth(0)
+	, bSignificanceLOD(false)
+	, bUseSignificanceManager(false)
+	, SignificanceUpdateInterval(0.5f)
+	, OffScreenDistanceScale(2.f)
+	, ViewConeHalfAngle(60.f)
+	, SignificanceUpdateTimer(0.f)
+{
+	auto AddQualityLevel = [this](float PreviewUpdateRateScale, bool bRepresentativeSocketOnly, int32 MaxLineOfSightChecks, float CheckIntervalScale)
+	{
+		FLockOnTargetQualitySettings& Settings = QualityLevels.AddDefaulted_GetRef();
+		Settings.PreviewUpdateRateScale = PreviewUpdateRateScale;
+		Settings.bRepresentativeSocketOnly = bRepresentativeSocketOnly;
+		Settings.MaxLineOfSightChecks = MaxLineOfSightChecks;
+		Settings.CheckIntervalScale = CheckIntervalScale;
+	};
+
+	AddQualityLevel(1.f, false, 0, 1.f);	//High
+	AddQualityLevel(2.f, false, 8, 1.5f);	//Medium
+	AddQualityLevel(4.f, true, 4, 2.f);		//Low
+	AddQualityLevel(8.f, true, 1, 4.f);		//Minimal
+
+	auto AddSignificanceLevel = [this](float MaxDistance, float CheckIntervalScale, float MaxSearchesPerSecond, bool bLineOfSight, float ModuleTickInterval)
+	{
+		FLockOnTargetSignificanceSettings& Settings = SignificanceLevels.AddDefaulted_GetRef();
+		Settings.MaxDistance = MaxDistance;
+		Settings.CheckIntervalScale = CheckIntervalScale;
+		Settings.MaxSearchesPerSecond = MaxSearchesPerSecond;
+		Settings.bLineOfSight = bLineOfSight;
+		Settings.ModuleTickInterval = ModuleTickInterval;
+	};
+
+	AddSignificanceLevel(2000.f, 1.f, 0.f, true, 0.f);
+	AddSignificanceLevel(5000.f, 2.f, 4.f, true, 0.1f);
+	AddSignificanceLevel(10000.f, 4.f, 1.f, true, 0.25f);
+	AddSignificanceLevel(0.f, 8.f, 0.2f, false, 0.5f);
+}
+
+ULockOnTargetGovernor* ULockOnTargetGovernor::Get(const UWorld* InWorld)
+{
+	return InWorld ? InWorld->GetSubsystem<ThisClass>() : nullptr;
+}
+
+const FLockOnTargetQualitySettings& ULockOnTargetGovernor::GetQualitySettings(const UWorld* InWorld)
+{
+	static const FLockOnTargetQualitySettings DefaultSettings;
+	const ULockOnTargetGovernor* const Governor = Get(InWorld);
+
+	return Governor && Governor->bEnabled ? Governor->GetCurrentQualitySettings() : DefaultSettings;
+}
+
+const FLockOnTargetSignificanceSettings& ULockOnTargetGovernor::GetSignificanceSettings(const ULockOnTargetComponent* Instigator)
+{
+	static const FLockOnTargetSignificanceSettings DefaultSettings;
+	const ULockOnTargetGovernor* const Governor = Instigator ? Get(Instigator->GetWorld()) : nullptr;
+
+	if (Governor && Governor->bSignificanceLOD && Governor->SignificanceLevels.IsValidIndex(Instigator->GetSignificanceLevel()))
+	{
+		return Governor->SignificanceLevels[Instigator->GetSignificanceLevel()];
+	}
+
+	return DefaultSettings;
+}
+
+bool ULockOnTargetGovernor::DoesSupportWorldType(const EWorldType::Type Type) const
+{
+	return Type == EWorldType::Game || Type == EWorldType::PIE;
+}
+
+TStatId ULockOnTargetGovernor::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULockOnTargetGovernor, STATGROUP_Tickables);
+}
+
+/*******************************************************************************************/
+/*******************************  Cost Measurement  ****************************************/
+/*******************************************************************************************/
+
+ULockOnTargetGovernor::FCostScope::FCostScope(ULockOnTargetGovernor* InGovernor)
+	: Governor(nullptr)
+	, StartTime(0.0)
+{
+	if (InGovernor && InGovernor->bEnabled)
+	{
+		Governor = InGovernor;
+
+		//Only the outermost scope measures.
+		if (Governor->ScopeDepth++ == 0)
+		{
+			StartTime = FPlatformTime::Seconds();
+		}
+	}
+}
+
+ULockOnTargetGovernor::FCostScope::~FCostScope()
+{
+	if (Governor && --Governor->ScopeDepth == 0)
+	{
+		Governor->FrameCostSeconds += FPlatformTime::Seconds() - StartTime;
+	}
+}
+
+/*******************************************************************************************/
+/*******************************  Quality  *************************************************/
+/*******************************************************************************************/
+
+const FLockOnTargetQualitySettings& ULockOnTargetGovernor::GetCurrentQualitySettings() const
+{
+	static const FLockOnTargetQualitySettings DefaultSettings;
+	const int32 Level = static_cast<int32>(Quality);
+
+	return QualityLevels.IsValidIndex(Level) ? QualityLevels[Level] : DefaultSettings;
+}
+
+void ULockOnTargetGovernor::SetQuality(ELockOnTargetQuality NewQuality)
+{
+	NewQuality = static_cast<ELockOnTargetQuality>(FMath::Clamp(static_cast<int32>(NewQuality), 0, static_cast<int32>(ELockOnTargetQuality::MAX) - 1));
+
+	if (Quality != NewQuality)
+	{
+		const FString OldName = StaticEnum<ELockOnTargetQuality>()->GetNameStringByValue(static_cast<int64>(Quality));
+		const FString NewName = StaticEnum<ELockOnTargetQuality>()->GetNameStringByValue(static_cast<int64>(NewQuality));
+
+		LOG("LockOnTarget quality %s -> %s (cost %.3f ms, budget %.3f ms).", *OldName, *NewName, AverageCostMs, BudgetMs);
+		TRACE_BOOKMARK(TEXT("LOT_Quality %s -> %s"), *OldName, *NewName);
+		CSV_EVENT(LockOnTarget, TEXT("Quality %s -> %s"), *OldName, *NewName);
+
+		Quality = NewQuality;
+		OverBudgetFrames = 0;
+		UnderBudgetFrames = 0;
+	}
+}
+
+void ULockOnTargetGovernor::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	//Scopes of the previous frame can't be left open.
+	ensure(ScopeDepth == 0);
+
+	const float FrameCostMs = static_cast<float>(FrameCostSeconds * 1000.0);
+	FrameCostSeconds = 0.0;
+
+	//The USignificanceManager recomputes the significance on its own.
+	if (bSignificanceLOD && !GetSignificanceManager())
+	{
+		SignificanceUpdateTimer += DeltaTime;
+
+		if (SignificanceUpdateTimer >= SignificanceUpdateInterval)
+		{
+			SignificanceUpdateTimer = 0.f;
+			UpdateSignificance();
+		}
+	}
+
+	if (!bEnabled)
+	{
+		return;
+	}
+
+	//Exponential moving average to smooth spikes, e.g. a single search on the lock press.
+	AverageCostMs = FMath::Lerp(AverageCostMs, FrameCostMs, 0.1f);
+	CSV_CUSTOM_STAT(LockOnTarget, CostMs, FrameCostMs, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(LockOnTarget, Quality, static_cast<int32>(Quality), ECsvCustomStatOp::Set);
+
+	if (AverageCostMs > BudgetMs)
+	{
+		UnderBudgetFrames = 0;
+
+		if (++OverBudgetFrames >= FramesToDegrade && Quality < ELockOnTargetQuality::Minimal)
+		{
+			SetQuality(static_cast<ELockOnTargetQuality>(static_cast<int32>(Quality) + 1));
+		}
+	}
+	else if (AverageCostMs < BudgetMs * RestoreBudgetRatio)
+	{
+		OverBudgetFrames = 0;
+
+		if (++UnderBudgetFrames >= FramesToRestore && Quality > ELockOnTargetQuality::High)
+		{
+			SetQuality(static_cast<ELockOnTargetQuality>(static_cast<int32>(Quality) - 1));
+		}
+	}
+	else
+	{
+		OverBudgetFrames = 0;
+		UnderBudgetFrames = 0;
+	}
+}
+
+/*******************************************************************************************/
+/*******************************  Significance  ********************************************/
+/*******************************************************************************************/
+
+//Player controlled instigators always keep the full fidelity.
+static bool IsAIInstigator(const ULockOnTargetComponent* Instigator)
+{
+	const AActor* const Owner = Instigator->GetOwner();
+	const APawn* const Pawn = Cast<APawn>(Owner);
+	const AController* const Controller = Pawn ? Pawn->GetController() : Cast<AController>(Owner);
+
+	return Controller && !Controller->IsPlayerController();
+}
+
+USignificanceManager* ULockOnTargetGovernor::GetSignificanceManager() const
+{
+#if LOT_SIGNIFICANCE_MANAGER
+	return bUseSignificanceManager ? USignificanceManager::Get(GetWorld()) : nullptr;
+#else
+	return nullptr;
+#endif
+}
+
+void ULockOnTargetGovernor::RegisterInstigator(ULockOnTargetComponent* Instigator)
+{
+	if (!bSignificanceLOD || !IsValid(Instigator))
+	{
+		return;
+	}
+
+	Instigators.AddUnique(Instigator);
+
+#if LOT_SIGNIFICANCE_MANAGER
+	if (USignificanceManager* const SignificanceManager = GetSignificanceManager())
+	{
+		auto SignificanceFunction = [this](USignificanceManager::FManagedObjectInfo* ObjectInfo, const FTransform& ViewPoint)
+		{
+			return CalculateSignificance(CastChecked<ULockOnTargetComponent>(ObjectInfo->GetObject()), ViewPoint);
+		};
+
+		auto PostSignificanceFunction = [this](USignificanceManager::FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal)
+		{
+			ULockOnTargetComponent* const Component = CastChecked<ULockOnTargetComponent>(ObjectInfo->GetObject());
+			Component->SignificanceLevel = GetSignificanceLevel(Component, Significance);
+		};
+
+		SignificanceManager->RegisterObject(Instigator, TEXT("LockOnTarget"), SignificanceFunction, USignificanceManager::EPostSignificanceType::Sequential, PostSignificanceFunction);
+	}
+#endif
+}
+
+void ULockOnTargetGovernor::UnregisterInstigator(ULockOnTargetComponent* Instigator)
+{
+	if (Instigators.RemoveSingleSwap(Instigator, false) > 0)
+	{
+		Instigator->SignificanceLevel = INDEX_NONE;
+
+#if LOT_SIGNIFICANCE_MANAGER
+		if (USignificanceManager* const SignificanceManager = GetSignificanceManager())
+		{
+			SignificanceManager->UnregisterObject(Instigator);
+		}
+#endif
+	}
+}
+
+void ULockOnTargetGovernor::UpdateSignificance()
+{
+	LOT_SCOPED_EVENT(GovernorUpdateSignificance, Orange);
+
+	//Remote players are also taken into account on the server.
+	TArray<FTransform, TInlineAllocator<4>> ViewPoints;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APlayerController* const PlayerController = It->Get())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			ViewPoints.Emplace(ViewRotation, ViewLocation);
+		}
+	}
+
+	Instigators.RemoveAllSwap([](const TWeakObjectPtr<ULockOnTargetComponent>& Instigator) { return !Instigator.IsValid(); }, false);
+
+	for (const TWeakObjectPtr<ULockOnTargetComponent>& WeakInstigator : Instigators)
+	{
+		ULockOnTargetComponent* const Instigator = WeakInstigator.Get();
+
+		//The closest view wins, the same as in the USignificanceManager.
+		float Significance = ViewPoints.IsEmpty() ? 0.f : TNumericLimits<float>::Lowest();
+
+		for (const FTransform& ViewPoint : ViewPoints)
+		{
+			Significance = FMath::Max(Significance, CalculateSignificance(Instigator, ViewPoint));
+		}
+
+		Instigator->SignificanceLevel = GetSignificanceLevel(Instigator, Significance);
+	}
+}
+
+float ULockOnTargetGovernor::CalculateSignificance(const ULockOnTargetComponent* Instigator, const FTransform& ViewPoint) const
+{
+	const FVector Direction = Instigator->GetOwner()->GetActorLocation() - ViewPoint.GetLocation();
+	double Distance = Direction.Size();
+
+	if (Distance > UE_KINDA_SMALL_NUMBER && ((Direction / Distance) | ViewPoint.GetUnitAxis(EAxis::X)) < FMath::Cos(FMath::DegreesToRadians(ViewConeHalfAngle)))
+	{
+		Distance *= OffScreenDistanceScale;
+	}
+
+	//The higher the more significant.
+	return static_cast<float>(-Distance);
+}
+
+int32 ULockOnTargetGovernor::GetSignificanceLevel(const ULockOnTargetComponent* Instigator, float Significance) const
+{
+	//Not a level at all, so the default settings are used rather than the configured closest level.
+	if (!IsAIInstigator(Instigator))
+	{
+		return INDEX_NONE;
+	}
+
+	const float Distance = -Significance;
+	int32 Level = 0;
+
+	//The last level catches the rest.
+	while (Level < SignificanceLevels.Num() - 1 && SignificanceLevels[Level].MaxDistance > 0.f && Distance > SignificanceLevels[Level].MaxDistance)
+	{
+		++Level;
+	}
+
+	return Level;
+}
@@ -0,0 +1,166 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "LockOnTargetTelemetry.h"
+#include "LockOnTargetDefines.h"
+
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/DateTime.h"
+#include "Async/Async.h"
+
+ULockOnTargetTelemetry::ULockOnTargetTelemetry()
+	: bEnabled(false)
+	, CellSize(2000.f)
+	, FlushInterval(30.f)
+	, FlushTimer(0.f)
+	, bDirty(false)
+	, ActiveScope(nullptr)
+{
+}
+
+ULockOnTargetTelemetry* ULockOnTargetTelemetry::Get(const UWorld* InWorld)
+{
+	return InWorld ? InWorld->GetSubsystem<ThisClass>() : nullptr;
+}
+
+bool ULockOnTargetTelemetry::DoesSupportWorldType(const EWorldType::Type Type) const
+{
+	return Type == EWorldType::Game || Type == EWorldType::PIE;
+}
+
+TStatId ULockOnTargetTelemetry::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULockOnTargetTelemetry, STATGROUP_Tickables);
+}
+
+void ULockOnTargetTelemetry::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (bEnabled)
+	{
+		const FString MapName = InWorld.RemovePIEPrefix(InWorld.GetMapName());
+		FilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("LockOnTarget"), TEXT("Telemetry"), FString::Printf(TEXT("%s_%s.csv"), *MapName, *FDateTime::Now().ToString()));
+		LOG("LockOnTarget telemetry is collected to %s", *FilePath);
+	}
+}
+
+void ULockOnTargetTelemetry::Deinitialize()
+{
+	Flush();
+	Super::Deinitialize();
+}
+
+/*******************************************************************************************/
+/*******************************  Recording  ***********************************************/
+/*******************************************************************************************/
+
+ULockOnTargetTelemetry::FRecordScope::FRecordScope(ULockOnTargetTelemetry* InTelemetry, ELockOnTargetTelemetryCall InCall, const FVector& InLocation, const int32& InCandidates, const int32& InTraces)
+	: Telemetry(InTelemetry && InTelemetry->bEnabled ? InTelemetry : nullptr)
+	, OuterScope(nullptr)
+	, Call(InCall)
+	, Location(InLocation)
+	, Candidates(InCandidates)
+	, Traces(InTraces)
+	, StartTime(Telemetry ? FPlatformTime::Seconds() : 0.0)
+	, NestedTime(0.0)
+{
+	if (Telemetry)
+	{
+		OuterScope = Telemetry->ActiveScope;
+		Telemetry->ActiveScope = this;
+	}
+}
+
+ULockOnTargetTelemetry::FRecordScope::~FRecordScope()
+{
+	if (Telemetry)
+	{
+		const double Duration = FPlatformTime::Seconds() - StartTime;
+		Telemetry->Record(Call, Location, (Duration - NestedTime) * 1000.0, Candidates, Traces);
+
+		if (OuterScope)
+		{
+			OuterScope->NestedTime += Duration;
+		}
+
+		Telemetry->ActiveScope = OuterScope;
+	}
+}
+
+void ULockOnTargetTelemetry::Record(ELockOnTargetTelemetryCall Call, const FVector& Location, double DurationMs, int32 Candidates, int32 Traces)
+{
+	const FIntPoint CellCoord(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+	FLockOnTargetTelemetryCell& Cell = Cells.FindOrAdd(CellCoord);
+
+	if (Call == ELockOnTargetTelemetryCall::FindTarget)
+	{
+		++Cell.Searches;
+		Cell.SearchTotalMs += DurationMs;
+		Cell.SearchMaxMs = FMath::Max(Cell.SearchMaxMs, static_cast<float>(DurationMs));
+	}
+	else
+	{
+		++Cell.Checks;
+		Cell.CheckTotalMs += DurationMs;
+		Cell.CheckMaxMs = FMath::Max(Cell.CheckMaxMs, static_cast<float>(DurationMs));
+	}
+
+	Cell.Candidates += Candidates;
+	Cell.Traces += Traces;
+	Cell.SumZ += Location.Z;
+	bDirty = true;
+}
+
+/*******************************************************************************************/
+/*******************************  Writing  *************************************************/
+/*******************************************************************************************/
+
+void ULockOnTargetTelemetry::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!bEnabled)
+	{
+		return;
+	}
+
+	FlushTimer += DeltaTime;
+
+	if (FlushTimer > FlushInterval)
+	{
+		FlushTimer = 0.f;
+		Flush();
+	}
+}
+
+void ULockOnTargetTelemetry::Flush()
+{
+	if (!bDirty || FilePath.IsEmpty())
+	{
+		return;
+	}
+
+	bDirty = false;
+
+	//Bounds are written instead of the cell coordinates, so the file doesn't depend on the config.
+	FString Csv = TEXT("MinX,MinY,MaxX,MaxY,Z,Searches,SearchTotalMs,SearchMaxMs,Checks,CheckTotalMs,CheckMaxMs,Candidates,Traces\n");
+
+	for (const auto& [CellCoord, Cell] : Cells)
+	{
+		const int32 Samples = Cell.Searches + Cell.Checks;
+
+		Csv += FString::Printf(TEXT("%.0f,%.0f,%.0f,%.0f,%.0f,%d,%.4f,%.4f,%d,%.4f,%.4f,%lld,%lld\n"),
+			CellCoord.X * CellSize, CellCoord.Y * CellSize, (CellCoord.X + 1) * CellSize, (CellCoord.Y + 1) * CellSize, Samples > 0 ? Cell.SumZ / Samples : 0.0,
+			Cell.Searches, Cell.SearchTotalMs, Cell.SearchMaxMs,
+			Cell.Checks, Cell.CheckTotalMs, Cell.CheckMaxMs,
+			Cell.Candidates, Cell.Traces);
+	}
+
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Csv = MoveTemp(Csv), Path = FilePath]()
+	{
+		FFileHelper::SaveStringToFile(Csv, *Path);
+	});
+}
@@ -0,0 +1,147 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "LockOnTargetTickManager.h"
+#include "LockOnTargetComponent.h"
+#include "LockOnTargetGovernor.h"
+#include "LockOnTargetDefines.h"
+
+#include "Engine/World.h"
+#include "Engine/Level.h"
+
+/*******************************************************************************************/
+/*******************************  Tick Function  *******************************************/
+/*******************************************************************************************/
+
+void FLockOnTargetTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Manager && TickType != LEVELTICK_ViewportsOnly)
+	{
+		Manager->Tick(DeltaTime);
+	}
+}
+
+FString FLockOnTargetTickFunction::DiagnosticMessage()
+{
+	return TEXT("LockOnTargetTickManager[Tick]");
+}
+
+FName FLockOnTargetTickFunction::DiagnosticContext(bool bDetailed)
+{
+	return FName(TEXT("LockOnTargetTickManager"));
+}
+
+/*******************************************************************************************/
+/*******************************  Tick Manager  ********************************************/
+/*******************************************************************************************/
+
+ULockOnTargetTickManager::ULockOnTargetTickManager()
+	: bIsTicking(false)
+	, bHasPendingRemovals(false)
+{
+	TickFunction.bCanEverTick = true;
+	TickFunction.bStartWithTickEnabled = true;
+	TickFunction.bAllowTickOnDedicatedServer = true;
+	TickFunction.TickGroup = TG_PostPhysics;
+	TickFunction.Manager = this;
+}
+
+ULockOnTargetTickManager* ULockOnTargetTickManager::Get(const UWorld* InWorld)
+{
+	return InWorld ? InWorld->GetSubsystem<ThisClass>() : nullptr;
+}
+
+bool ULockOnTargetTickManager::DoesSupportWorldType(const EWorldType::Type Type) const
+{
+	return Type == EWorldType::Game || Type == EWorldType::PIE;
+}
+
+void ULockOnTargetTickManager::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+
+	Components.Reset();
+
+	Super::Deinitialize();
+}
+
+void ULockOnTargetTickManager::RegisterComponent(ULockOnTargetComponent* Component)
+{
+	if (IsValid(Component) && !Components.Contains(Component))
+	{
+		Components.Add(Component);
+
+		//Lazily registered, so worlds without aggregated components don't tick.
+		if (!TickFunction.IsTickFunctionRegistered() && GetWorld() && GetWorld()->PersistentLevel)
+		{
+			TickFunction.RegisterTickFunction(GetWorld()->PersistentLevel);
+		}
+	}
+}
+
+void ULockOnTargetTickManager::UnregisterComponent(ULockOnTargetComponent* Component)
+{
+	const int32 Index = Components.Find(Component);
+
+	if (Index != INDEX_NONE)
+	{
+		if (bIsTicking)
+		{
+			Components[Index] = nullptr;
+			bHasPendingRemovals = true;
+		}
+		else
+		{
+			Components.RemoveAtSwap(Index);
+		}
+	}
+}
+
+void ULockOnTargetTickManager::Tick(float DeltaTime)
+{
+	LOT_SCOPED_EVENT(TickManager, Red);
+	const ULockOnTargetGovernor::FCostScope CostScope(ULockOnTargetGovernor::Get(GetWorld()));
+
+	TGuardValue<bool> TickingGuard(bIsTicking, true);
+
+	//Components registered during the tick will be ticked the next frame.
+	const int32 ComponentsNum = Components.Num();
+
+	//Deactivated components don't tick, the same as with their own tick function.
+	auto ShouldTick = [](const ULockOnTargetComponent* Component) { return Component && Component->IsActive(); };
+
+	//The component's own tick function is dilated by the owner, so is the aggregated one.
+	auto GetDilatedDeltaTime = [DeltaTime](const ULockOnTargetComponent* Component) { return DeltaTime * Component->GetOwner()->CustomTimeDilation; };
+
+	{
+		LOT_SCOPED_EVENT(TickManagerTargeting, Red);
+
+		for (int32 i = 0; i < ComponentsNum; ++i)
+		{
+			if (ULockOnTargetComponent* const Component = Components[i]; ShouldTick(Component))
+			{
+				Component->TickTargeting(GetDilatedDeltaTime(Component));
+			}
+		}
+	}
+
+	{
+		LOT_SCOPED_EVENT(TickManagerModules, Red);
+
+		for (int32 i = 0; i < ComponentsNum; ++i)
+		{
+			if (ULockOnTargetComponent* const Component = Components[i]; ShouldTick(Component))
+			{
+				Component->TickModules(GetDilatedDeltaTime(Component));
+			}
+		}
+	}
+
+	if (bHasPendingRemovals)
+	{
+		Components.RemoveAllSwap([](const ULockOnTargetComponent* Component) { return Component == nullptr; });
+		bHasPendingRemovals = false;
+	}
+}
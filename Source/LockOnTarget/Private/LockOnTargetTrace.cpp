@@ -0,0 +1,112 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "LockOnTargetTrace.h"
+
+#if LOT_TRACE_ENABLED
+
+#include "LockOnTargetComponent.h"
+#include "TargetComponent.h"
+
+#include "HAL/PlatformTime.h"
+
+UE_TRACE_CHANNEL_DEFINE(LockOnTargetChannel);
+
+//Field names are shared with FLockOnTargetTraceAnalyzer.
+
+UE_TRACE_EVENT_BEGIN(LockOnTarget, TargetEvent)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, InstigatorId)
+	UE_TRACE_EVENT_FIELD(uint8, Event)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, InstigatorName)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, TargetName)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Socket)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(LockOnTarget, Search)
+	UE_TRACE_EVENT_FIELD(uint64, StartCycle)
+	UE_TRACE_EVENT_FIELD(uint64, EndCycle)
+	UE_TRACE_EVENT_FIELD(uint32, InstigatorId)
+	UE_TRACE_EVENT_FIELD(int32, NumCandidates)
+	UE_TRACE_EVENT_FIELD(int32, NumTraces)
+	UE_TRACE_EVENT_FIELD(bool, bFound)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(LockOnTarget, LineOfSightTraces)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, FrameNumber)
+	UE_TRACE_EVENT_FIELD(uint32, InstigatorId)
+	UE_TRACE_EVENT_FIELD(int32, NumTraces)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(LockOnTarget, LineOfSightTimer)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, InstigatorId)
+	UE_TRACE_EVENT_FIELD(bool, bActive)
+UE_TRACE_EVENT_END()
+
+void FLockOnTargetTrace::OutputTargetEvent(const ULockOnTargetComponent* Instigator, ELockOnTargetTraceEvent Event, const UTargetComponent* Target, FName Socket)
+{
+	if (!UE_TRACE_CHANNELEXPR_IS_ENABLED(LockOnTargetChannel) || !Instigator)
+	{
+		return;
+	}
+
+	//Names are only sent with the rare Target events. Other events refer to the instigator by id.
+	const FString InstigatorName = GetNameSafe(Instigator->GetOwner());
+	const FString TargetName = GetNameSafe(Target ? Target->GetOwner() : nullptr);
+	const FString SocketName = Socket.ToString();
+
+	UE_TRACE_LOG(LockOnTarget, TargetEvent, LockOnTargetChannel)
+		<< TargetEvent.Cycle(FPlatformTime::Cycles64())
+		<< TargetEvent.InstigatorId(Instigator->GetUniqueID())
+		<< TargetEvent.Event(static_cast<uint8>(Event))
+		<< TargetEvent.InstigatorName(*InstigatorName, InstigatorName.Len())
+		<< TargetEvent.TargetName(*TargetName, TargetName.Len())
+		<< TargetEvent.Socket(*SocketName, SocketName.Len());
+}
+
+void FLockOnTargetTrace::OutputSearch(const ULockOnTargetComponent* Instigator, uint64 StartCycle, int32 NumCandidates, int32 NumTraces, bool bFound)
+{
+	if (!UE_TRACE_CHANNELEXPR_IS_ENABLED(LockOnTargetChannel) || !Instigator)
+	{
+		return;
+	}
+
+	UE_TRACE_LOG(LockOnTarget, Search, LockOnTargetChannel)
+		<< Search.StartCycle(StartCycle)
+		<< Search.EndCycle(FPlatformTime::Cycles64())
+		<< Search.InstigatorId(Instigator->GetUniqueID())
+		<< Search.NumCandidates(NumCandidates)
+		<< Search.NumTraces(NumTraces)
+		<< Search.bFound(bFound);
+}
+
+void FLockOnTargetTrace::OutputLineOfSightTraces(const ULockOnTargetComponent* Instigator, int32 NumTraces)
+{
+	if (!UE_TRACE_CHANNELEXPR_IS_ENABLED(LockOnTargetChannel) || !Instigator || NumTraces <= 0)
+	{
+		return;
+	}
+
+	//The analyzer sums traces of the same frame.
+	UE_TRACE_LOG(LockOnTarget, LineOfSightTraces, LockOnTargetChannel)
+		<< LineOfSightTraces.Cycle(FPlatformTime::Cycles64())
+		<< LineOfSightTraces.FrameNumber(GFrameCounter)
+		<< LineOfSightTraces.InstigatorId(Instigator->GetUniqueID())
+		<< LineOfSightTraces.NumTraces(NumTraces);
+}
+
+void FLockOnTargetTrace::OutputLineOfSightTimer(const ULockOnTargetComponent* Instigator, bool bActive)
+{
+	if (!UE_TRACE_CHANNELEXPR_IS_ENABLED(LockOnTargetChannel) || !Instigator)
+	{
+		return;
+	}
+
+	UE_TRACE_LOG(LockOnTarget, LineOfSightTimer, LockOnTargetChannel)
+		<< LineOfSightTimer.Cycle(FPlatformTime::Cycles64())
+		<< LineOfSightTimer.InstigatorId(Instigator->GetUniqueID())
+		<< LineOfSightTimer.bActive(bActive);
+}
+
+#endif //LOT_TRACE_ENABLED
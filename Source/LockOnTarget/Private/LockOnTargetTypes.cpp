@@ -2,7 +2,11 @@
 
 #include "LockOnTargetTypes.h"
 #include "TargetComponent.h"
+#include "TargetManager.h"
 #include "GameFramework/Actor.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Components/WidgetComponent.h"
 
 /********************************************************************
  * FTargetInfo
@@ -12,7 +16,7 @@ const FTargetInfo FTargetInfo::NULL_TARGET = { nullptr, NAME_None };
 
 bool FTargetInfo::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
 {
-	//[ IsTargetValid? ]~[ NetGUID/Name ][ IsDefaultSocket? ]~[ Socket Idx ]
+	//[ IsTargetValid? ]~[ IsCompactId? ]~[ Compact ID | NetGUID/Name ][ IsDefaultSocket? ]~[ Socket Idx ]
 
 	bool bTargetMapped = true;
 	bOutSuccess = true;
@@ -22,27 +26,59 @@ bool FTargetInfo::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess
 
 	if(bIsValid)
 	{
-		//As of 5.1, the mapping of components is broken, they're mapped only once, so their owner is serialized instead.
-		UObject* TargetOwner = nullptr;
+		uint8 bCompactId = 0;
 
-		if(Ar.IsSaving())
+#if LOT_COMPACT_TARGET_IDS
+		//The ID assigned by the server UTargetManager. The Target falls back to the object reference if it has none.
+		uint32 CompactId = 0;
+
+		if (Ar.IsSaving())
 		{
-			TargetOwner = TargetComponent->GetOwner();
+			CompactId = TargetComponent->GetNetTargetId();
+			bCompactId = CompactId != 0;
 		}
-		
-		bTargetMapped = Map->SerializeObject(Ar, AActor::StaticClass(), TargetOwner);
 
-		if(Ar.IsLoading())
+		Ar.SerializeBits(&bCompactId, 1);
+
+		if (bCompactId)
 		{
-			if(bTargetMapped)
+			Ar.SerializeInt(CompactId, 1u << UTargetManager::NetTargetIdBits);
+
+			if (Ar.IsLoading())
 			{
-				TargetComponent = static_cast<AActor*>(TargetOwner)->FindComponentByClass<UTargetComponent>();
-				checkf(TargetComponent, TEXT("Serialized Target %s doesn't have UTargetComponent."), *GetFullNameSafe(TargetOwner));
+				//The receiver resolves the ID through its UTargetManager.
+				TargetComponent = nullptr;
+				NetTargetId = CompactId;
 			}
-			else
+		}
+#endif
+
+		if (!bCompactId)
+		{
+			//As of 5.1, the mapping of components is broken, they're mapped only once, so their owner is serialized instead.
+			UObject* TargetOwner = nullptr;
+
+			if(Ar.IsSaving())
 			{
-				//Target isn't mapped, so we need to clear the old one if it exists.
-				TargetComponent = nullptr;
+				TargetOwner = TargetComponent->GetOwner();
+			}
+			
+			bTargetMapped = Map->SerializeObject(Ar, AActor::StaticClass(), TargetOwner);
+
+			if(Ar.IsLoading())
+			{
+				NetTargetId = 0;
+
+				if(bTargetMapped)
+				{
+					TargetComponent = static_cast<AActor*>(TargetOwner)->FindComponentByClass<UTargetComponent>();
+					checkf(TargetComponent, TEXT("Serialized Target %s doesn't have UTargetComponent."), *GetFullNameSafe(TargetOwner));
+				}
+				else
+				{
+					//Target isn't mapped, so we need to clear the old one if it exists.
+					TargetComponent = nullptr;
+				}
 			}
 		}
 
@@ -69,6 +105,8 @@ bool FTargetInfo::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess
 
 		if (Ar.IsLoading())
 		{
+			NetSocketIndex = SocketIdx;
+
 			//If the Target is mapped and TargetComponent is found, we can find the actual Socket.
 			if (IsValid(TargetComponent))
 			{
@@ -84,17 +122,44 @@ bool FTargetInfo::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess
 					Socket = NAME_None;
 				}
 			}
+			else
+			{
+				Socket = NAME_None;
+			}
 		}
 	}
 	else
 	{
 		TargetComponent = nullptr;
 		Socket = NAME_None;
+		NetTargetId = 0;
 	}
 
 	return bTargetMapped;
 }
 
+bool FTargetInfo::ResolveNetTarget(const UTargetManager& TargetManager)
+{
+	if (!IsNetTargetPending())
+	{
+		return true;
+	}
+
+	TargetComponent = TargetManager.ResolveNetTargetId(NetTargetId);
+
+	if (!TargetComponent)
+	{
+		return false;
+	}
+
+	const TArray<FName>& Sockets = TargetComponent->GetSockets();
+	Socket = Sockets.IsValidIndex(NetSocketIndex) ? Sockets[NetSocketIndex] : NAME_None;
+	NetTargetId = 0;
+	NetSocketIndex = 0;
+
+	return true;
+}
+
 uint32 FTargetInfo::GetSocketIndex() const
 {
 	int32 Index = 0;
@@ -233,3 +298,62 @@ bool FTargetInfo::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
 }
 
 #endif
+
+/********************************************************************
+ * FWidgetCullingSettings
+ ********************************************************************/
+
+bool FWidgetCullingSettings::Evaluate(const APlayerController* PlayerController, const FVector& Location) const
+{
+	if (!PlayerController || !PlayerController->PlayerCameraManager)
+	{
+		return true;
+	}
+
+	const float Distance = FVector::Dist(PlayerController->PlayerCameraManager->GetCameraLocation(), Location);
+
+	if (CullDistance > 0.f && Distance > CullDistance)
+	{
+		return false;
+	}
+
+	if (bCullOffScreen)
+	{
+		FVector2D ScreenPosition;
+
+		//Fails for the locations behind the camera.
+		if (!PlayerController->ProjectWorldLocationToScreen(Location, ScreenPosition, true))
+		{
+			return false;
+		}
+
+		int32 SizeX = 0, SizeY = 0;
+		PlayerController->GetViewportSize(SizeX, SizeY);
+
+		if (SizeX > 0 && SizeY > 0)
+		{
+			const FVector2D Margin(SizeX * OffScreenMargin, SizeY * OffScreenMargin);
+
+			if (ScreenPosition.X < -Margin.X || ScreenPosition.X > SizeX + Margin.X || ScreenPosition.Y < -Margin.Y || ScreenPosition.Y > SizeY + Margin.Y)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void FWidgetCullingSettings::UpdateWidget(UWidgetComponent* Widget, const APlayerController* PlayerController, bool& bInOutIsCulled, bool bIsHiddenManually) const
+{
+	check(Widget);
+
+	const bool bShouldCull = !Evaluate(PlayerController, Widget->GetComponentLocation());
+
+	//The visibility is only changed on flips, so it isn't propagated to the children every frame.
+	if (bShouldCull != bInOutIsCulled)
+	{
+		bInOutIsCulled = bShouldCull;
+		Widget->SetVisibility(!bInOutIsCulled && !bIsHiddenManually);
+	}
+}
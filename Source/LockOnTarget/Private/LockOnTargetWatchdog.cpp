@@ -0,0 +1,138 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "LockOnTargetWatchdog.h"
+#include "LockOnTargetDefines.h"
+
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/DateTime.h"
+#include "Async/Async.h"
+#include "UObject/UnrealType.h"
+#include "ProfilingDebugging/MiscTrace.h"
+
+ULockOnTargetWatchdog::ULockOnTargetWatchdog()
+	: bEnabled(false)
+	, ThresholdMs(2.f)
+	, MaxCapturesPerWorld(16)
+	, CapturesWritten(0)
+{
+}
+
+ULockOnTargetWatchdog* ULockOnTargetWatchdog::Get(const UWorld* InWorld)
+{
+	return InWorld ? InWorld->GetSubsystem<ThisClass>() : nullptr;
+}
+
+bool ULockOnTargetWatchdog::DoesSupportWorldType(const EWorldType::Type Type) const
+{
+	return Type == EWorldType::Game || Type == EWorldType::PIE;
+}
+
+/*******************************************************************************************/
+/*******************************  Capture  *************************************************/
+/*******************************************************************************************/
+
+void FLockOnTargetWatchdogCapture::MarkStage(const TCHAR* StageName)
+{
+	const double Now = FPlatformTime::Seconds();
+	StageTimingsMs.Emplace(StageName, (Now - LastStageTime) * 1000.0);
+	LastStageTime = Now;
+}
+
+ULockOnTargetWatchdog::FWatchScope::FWatchScope(ULockOnTargetWatchdog* InWatchdog, const TCHAR* ScopeName, const UObject* Instigator)
+	: Watchdog(nullptr)
+{
+	if (InWatchdog && InWatchdog->bEnabled)
+	{
+		Watchdog = InWatchdog;
+
+		FLockOnTargetWatchdogCapture& NewCapture = Capture.Emplace();
+		NewCapture.ScopeName = ScopeName;
+		NewCapture.InstigatorObject = Instigator;
+		NewCapture.FrameNumber = GFrameCounter;
+		NewCapture.StartTime = NewCapture.LastStageTime = FPlatformTime::Seconds();
+	}
+}
+
+ULockOnTargetWatchdog::FWatchScope::~FWatchScope()
+{
+	if (Watchdog && Capture.IsSet())
+	{
+		const double DurationMs = (FPlatformTime::Seconds() - Capture->StartTime) * 1000.0;
+
+		if (DurationMs > Watchdog->ThresholdMs)
+		{
+			Watchdog->WriteCapture(*Capture, DurationMs);
+		}
+	}
+}
+
+/*******************************************************************************************/
+/*******************************  Writing  *************************************************/
+/*******************************************************************************************/
+
+void ULockOnTargetWatchdog::WriteCapture(const FLockOnTargetWatchdogCapture& Capture, double DurationMs)
+{
+	//The bookmark is always emitted, even if the capture limit is reached.
+	TRACE_BOOKMARK(TEXT("LOT_Watchdog %s %.3f ms"), Capture.ScopeName, DurationMs);
+
+	if (CapturesWritten >= MaxCapturesPerWorld)
+	{
+		return;
+	}
+
+	++CapturesWritten;
+
+	FString Report;
+	Report += FString::Printf(TEXT("Scope: %s\n"), Capture.ScopeName);
+	Report += FString::Printf(TEXT("Duration: %.3f ms (threshold %.3f ms)\n"), DurationMs, ThresholdMs);
+	Report += FString::Printf(TEXT("Frame: %llu\n"), Capture.FrameNumber);
+	Report += FString::Printf(TEXT("Instigator: %s\n"), *GetPathNameSafe(Capture.InstigatorObject));
+	Report += FString::Printf(TEXT("View location: %s\n"), *Capture.ViewLocation.ToString());
+	Report += FString::Printf(TEXT("Blueprint hook calls: %d\n"), Capture.BlueprintHookCalls);
+	Report += FString::Printf(TEXT("Traces issued: %d\n"), Capture.TracesIssued);
+
+	//Hooks overridden in script are the usual suspects.
+	if (IsValid(Capture.InstigatorObject))
+	{
+		const UClass* const InstigatorClass = Capture.InstigatorObject->GetClass();
+		Report += TEXT("Script overrides:");
+
+		for (TFieldIterator<UFunction> It(InstigatorClass); It; ++It)
+		{
+			if (It->HasAnyFunctionFlags(FUNC_BlueprintEvent) && It->HasAnyFunctionFlags(FUNC_Native) && InstigatorClass->IsFunctionImplementedInScript(It->GetFName()))
+			{
+				Report += FString::Printf(TEXT(" %s"), *It->GetName());
+			}
+		}
+
+		Report += TEXT("\n");
+	}
+
+	Report += TEXT("\nStages:\n");
+
+	for (const auto& [StageName, StageMs] : Capture.StageTimingsMs)
+	{
+		Report += FString::Printf(TEXT("  %-24s %.3f ms\n"), StageName, StageMs);
+	}
+
+	Report += FString::Printf(TEXT("\nCandidates (%d):\n"), Capture.Candidates.Num());
+
+	for (const FLockOnTargetWatchdogCapture::FCandidate& Candidate : Capture.Candidates)
+	{
+		Report += FString::Printf(TEXT("  %-12.3f %s [%s] at %s\n"), Candidate.Modifier, *Candidate.Target, *Candidate.Socket.ToString(), *Candidate.Location.ToString());
+	}
+
+	const FString FilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("LockOnTarget"), TEXT("Watchdog"),
+		FString::Printf(TEXT("%s_%llu_%s.txt"), Capture.ScopeName, Capture.FrameNumber, *FDateTime::Now().ToString()));
+
+	LOG_WARNING("%s took %.3f ms (threshold %.3f ms). Capture: %s", Capture.ScopeName, DurationMs, ThresholdMs, *FilePath);
+
+	//The report is already built, so the disk IO doesn't extend the spike.
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Report = MoveTemp(Report), FilePath]()
+	{
+		FFileHelper::SaveStringToFile(Report, *FilePath);
+	});
+}
@@ -0,0 +1,65 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "QueryTargetsAsyncAction.h"
+#include "TargetManager.h"
+#include "TargetComponent.h"
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Async/Async.h"
+
+UQueryTargetsAsyncAction* UQueryTargetsAsyncAction::QueryTargetsAsync(UObject* WorldContextObject, const FTargetQuery& Query)
+{
+	UQueryTargetsAsyncAction* const Action = NewObject<UQueryTargetsAsyncAction>();
+	Action->World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	Action->Query = Query;
+	Action->RegisterWithGameInstance(WorldContextObject);
+
+	return Action;
+}
+
+void UQueryTargetsAsyncAction::Activate()
+{
+	Super::Activate();
+
+	if (!World || !World->HasSubsystem<UTargetManager>())
+	{
+		OnQueryCompleted({});
+		return;
+	}
+
+	//The entries are copied, so the manager is free to update them while the query runs.
+	TArray<FTargetQueryEntry> Entries(UTargetManager::Get(*World).GetQueryEntries());
+	TWeakObjectPtr<ThisClass> WeakThis(this);
+
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakThis, Entries = MoveTemp(Entries), Query = Query]()
+	{
+		TArray<FTargetQueryResult> Results;
+		TargetQuery::Execute(Entries, Query, Results);
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Results = MoveTemp(Results)]() mutable
+		{
+			if (UQueryTargetsAsyncAction* const Action = WeakThis.Get())
+			{
+				Action->OnQueryCompleted(MoveTemp(Results));
+			}
+		});
+	});
+}
+
+void UQueryTargetsAsyncAction::OnQueryCompleted(TArray<FTargetQueryResult>&& Results)
+{
+	//The weak pointer rejects a new Target allocated at the address of a destroyed one.
+	if (World && World->HasSubsystem<UTargetManager>())
+	{
+		const UTargetManager& TargetManager = UTargetManager::Get(*World);
+		Results.RemoveAll([&TargetManager](const FTargetQueryResult& Result) { return !Result.Target.IsValid() || !TargetManager.IsTargetRegistered(Result.Target.Get()); });
+	}
+	else
+	{
+		Results.Reset();
+	}
+
+	Completed.Broadcast(Results);
+	SetReadyToDestroy();
+}
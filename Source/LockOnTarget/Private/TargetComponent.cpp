@@ -5,7 +5,87 @@
 #include "LockOnTargetComponent.h"
 #include "LockOnTargetDefines.h"
 
+#include "Net/UnrealNetwork.h"
 #include "Components/MeshComponent.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshSocket.h"
+
+#if WITH_EDITOR
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/SimpleConstructionScript.h"
+#include "Engine/SCS_Node.h"
+#include "UObject/ObjectSaveContext.h"
+#endif
+
+static const UObject* GetMeshAsset(const USceneComponent* Mesh)
+{
+	if (const USkinnedMeshComponent* const SkinnedMesh = Cast<USkinnedMeshComponent>(Mesh))
+	{
+		return SkinnedMesh->GetSkinnedAsset();
+	}
+
+	if (const UStaticMeshComponent* const StaticMesh = Cast<UStaticMeshComponent>(Mesh))
+	{
+		return StaticMesh->GetStaticMesh();
+	}
+
+	return nullptr;
+}
+
+//Resolves the Socket to a bone/component relative location. Sockets and bones are both supported.
+static bool ResolveSocket(const USceneComponent* Mesh, FName Socket, FBakedTargetSocket& OutBakedSocket)
+{
+	OutBakedSocket = FBakedTargetSocket();
+	OutBakedSocket.Socket = Socket;
+
+	if (!Mesh)
+	{
+		return false;
+	}
+
+	if (Socket == NAME_None)
+	{
+		//The component location is used for the None Socket.
+		OutBakedSocket.bResolved = true;
+	}
+	else if (const USkinnedMeshComponent* const SkinnedMesh = Cast<USkinnedMeshComponent>(Mesh))
+	{
+		if (const USkeletalMesh* const SkeletalMesh = Cast<USkeletalMesh>(SkinnedMesh->GetSkinnedAsset()))
+		{
+			FTransform SocketTransform;
+			int32 BoneIndex = INDEX_NONE;
+			int32 SocketIndex = INDEX_NONE;
+
+			if (SkeletalMesh->FindSocketInfo(Socket, SocketTransform, BoneIndex, SocketIndex))
+			{
+				OutBakedSocket.RelativeLocation = SocketTransform.GetLocation();
+			}
+			else
+			{
+				BoneIndex = SkeletalMesh->GetRefSkeleton().FindBoneIndex(Socket);
+			}
+
+			OutBakedSocket.BoneIndex = BoneIndex;
+			OutBakedSocket.bResolved = BoneIndex != INDEX_NONE;
+		}
+	}
+	else if (const UStaticMeshComponent* const StaticMeshComponent = Cast<UStaticMeshComponent>(Mesh))
+	{
+		if (const UStaticMesh* const StaticMesh = StaticMeshComponent->GetStaticMesh())
+		{
+			if (const UStaticMeshSocket* const StaticMeshSocket = StaticMesh->FindSocket(Socket))
+			{
+				OutBakedSocket.RelativeLocation = StaticMeshSocket->RelativeLocation;
+				OutBakedSocket.bResolved = true;
+			}
+		}
+	}
+
+	return OutBakedSocket.bResolved;
+}
 
 UTargetComponent::UTargetComponent()
 	: bCanBeCaptured(true)
@@ -18,10 +98,17 @@ UTargetComponent::UTargetComponent()
 	, bWantsDisplayWidget(true)
 	, WidgetRelativeOffset(0.f)
 	, bSkipMeshInitializationByName(false)
+	, bUseBakedSockets(false)
+	, NetTargetId(0)
 {
 	PrimaryComponentTick.bCanEverTick = false;
 	PrimaryComponentTick.bStartWithTickEnabled = false;
 	Sockets.Add(NAME_None);
+
+#if LOT_COMPACT_TARGET_IDS
+	//Only to send the NetTargetId once.
+	SetIsReplicatedByDefault(true);
+#endif
 }
 
 UTargetManager& UTargetComponent::GetTargetManager() const
@@ -38,6 +125,8 @@ void UTargetComponent::BeginPlay()
 	{
 		TrackedMeshComponent = FindMeshComponent();
 	}
+
+	ValidateBakedSockets();
 }
 
 void UTargetComponent::EndPlay(EEndPlayReason::Type Reason)
@@ -48,6 +137,33 @@ void UTargetComponent::EndPlay(EEndPlayReason::Type Reason)
 	verify(GetTargetManager().UnregisterTarget(this));
 }
 
+void UTargetComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Params;
+	Params.Condition = COND_InitialOnly; //The ID doesn't change while the Target is registered.
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, NetTargetId, Params);
+}
+
+void UTargetComponent::OnRep_NetTargetId()
+{
+	//The ID might be received after BeginPlay, e.g. for a component added at runtime.
+	if (HasBegunPlay())
+	{
+		GetTargetManager().MapNetTargetId(this);
+	}
+}
+
+void UTargetComponent::RefreshQueryEntry()
+{
+	//Only registered Targets have the entry.
+	if (HasBegunPlay())
+	{
+		GetTargetManager().RefreshQueryEntry(this);
+	}
+}
+
 /**
  * Target State
  */
@@ -71,6 +187,7 @@ bool UTargetComponent::IsCaptured() const
 void UTargetComponent::SetCanBeCaptured(bool bInCanBeCaptured)
 {
 	bCanBeCaptured = bInCanBeCaptured;
+	RefreshQueryEntry();
 
 	if (!bCanBeCaptured)
 	{
@@ -89,6 +206,7 @@ void UTargetComponent::CaptureTarget(ULockOnTargetComponent* Instigator)
 	{
 		checkf(IsSocketValid(Instigator->GetCapturedSocket()), TEXT("Captured socket doesn't exists in the Target."));
 		Invaders.Add(Instigator);
+		RefreshQueryEntry();
 		K2_OnCaptured(Instigator);
 		OnCaptured.Broadcast(Instigator);
 	}
@@ -99,6 +217,7 @@ void UTargetComponent::ReleaseTarget(ULockOnTargetComponent* Instigator)
 	if (ensure(IsValid(Instigator)))
 	{
 		verify(Invaders.RemoveSingleSwap(Instigator, false));
+		RefreshQueryEntry();
 		K2_OnReleased(Instigator);
 		OnReleased.Broadcast(Instigator);
 	}
@@ -129,7 +248,22 @@ bool UTargetComponent::IsSocketValid(FName Socket) const
 
 FVector UTargetComponent::GetSocketLocation(FName Socket) const
 {
-	return GetTrackedMeshComponent() ? GetTrackedMeshComponent()->GetSocketLocation(Socket) : GetOwner()->GetActorLocation();
+	const USceneComponent* const Mesh = GetTrackedMeshComponent();
+
+	if (!Mesh)
+	{
+		return GetOwner()->GetActorLocation();
+	}
+
+	if (bUseBakedSockets)
+	{
+		if (const int32 SocketIndex = Sockets.IndexOfByKey(Socket); SocketIndex != INDEX_NONE && BakedSockets[SocketIndex].bResolved)
+		{
+			return GetBakedSocketLocation(Mesh, BakedSockets[SocketIndex]);
+		}
+	}
+
+	return Mesh->GetSocketLocation(Socket);
 }
 
 bool UTargetComponent::AddSocket(FName Socket)
@@ -140,6 +274,12 @@ bool UTargetComponent::AddSocket(FName Socket)
 	{
 		Sockets.Add(Socket);
 		bAdded = true;
+		RefreshQueryEntry();
+
+		if (bUseBakedSockets)
+		{
+			ResolveSocket(GetTrackedMeshComponent(), Socket, BakedSockets.AddDefaulted_GetRef());
+		}
 	}
 
 	return bAdded;
@@ -147,10 +287,19 @@ bool UTargetComponent::AddSocket(FName Socket)
 
 bool UTargetComponent::RemoveSocket(FName Socket)
 {
-	const bool bRemoved = Sockets.RemoveSingle(Socket) > 0;
+	const int32 SocketIndex = Sockets.IndexOfByKey(Socket);
+	const bool bRemoved = SocketIndex != INDEX_NONE;
 
 	if (bRemoved)
 	{
+		Sockets.RemoveAt(SocketIndex);
+
+		if (bUseBakedSockets)
+		{
+			BakedSockets.RemoveAt(SocketIndex);
+		}
+
+		RefreshQueryEntry();
 		DispatchTargetException(ETargetExceptionType::SocketInvalidation);
 	}
 
@@ -174,7 +323,16 @@ FVector UTargetComponent::GetFocusLocation(const ULockOnTargetComponent* Instiga
 
 	case EFocusPoint::CustomSocket:
 
-		FocusPointLocation = GetSocketLocation(FocusPointCustomSocket);
+		//FocusPointCustomSocket can be changed at runtime, so the baked name is checked on each call.
+		if (bUseBakedSockets && BakedFocusPointSocket.bResolved && BakedFocusPointSocket.Socket == FocusPointCustomSocket)
+		{
+			FocusPointLocation = GetBakedSocketLocation(GetTrackedMeshComponent(), BakedFocusPointSocket);
+		}
+		else
+		{
+			FocusPointLocation = GetSocketLocation(FocusPointCustomSocket);
+		}
+
 		break;
 
 	case EFocusPoint::Custom:
@@ -217,6 +375,10 @@ void UTargetComponent::SetTrackedMeshComponent(USceneComponent* InTrackedCompone
 		{
 			bSkipMeshInitializationByName = true;
 		}
+		else
+		{
+			ValidateBakedSockets();
+		}
 	}
 }
 
@@ -237,3 +399,111 @@ USceneComponent* UTargetComponent::GetRootComponent() const
 {
 	return GetOwner() ? GetOwner()->GetRootComponent() : nullptr;
 }
+
+/**
+ * Baked Sockets
+ */
+
+void UTargetComponent::ValidateBakedSockets()
+{
+	const USceneComponent* const Mesh = GetTrackedMeshComponent();
+	ValidatedMeshAsset = GetMeshAsset(Mesh);
+	bUseBakedSockets = Mesh && BakedSockets.Num() == Sockets.Num() && BakedMeshAsset == FSoftObjectPath(ValidatedMeshAsset.Get());
+
+	for (int32 i = 0; bUseBakedSockets && i < Sockets.Num(); ++i)
+	{
+		bUseBakedSockets = BakedSockets[i].Socket == Sockets[i];
+	}
+}
+
+FVector UTargetComponent::GetBakedSocketLocation(const USceneComponent* Mesh, const FBakedTargetSocket& BakedSocket) const
+{
+	check(Mesh && BakedSocket.bResolved);
+
+	//The mesh asset may have been swapped after the validation (e.g. by SetSkinnedAssetAndUpdate()), so the baked data doesn't match it anymore.
+	if (GetMeshAsset(Mesh) != ValidatedMeshAsset.Get())
+	{
+		return Mesh->GetSocketLocation(BakedSocket.Socket);
+	}
+
+	if (BakedSocket.BoneIndex != INDEX_NONE)
+	{
+		//The mesh asset has been validated, so the bone index must be valid for the skinned component.
+		return static_cast<const USkinnedMeshComponent*>(Mesh)->GetBoneTransform(BakedSocket.BoneIndex).TransformPosition(BakedSocket.RelativeLocation);
+	}
+
+	return Mesh->GetComponentTransform().TransformPosition(BakedSocket.RelativeLocation);
+}
+
+#if WITH_EDITOR
+
+bool UTargetComponent::BakeSockets(const USceneComponent* Mesh)
+{
+	bool bAllSocketsValid = true;
+
+	BakedSockets.Reset(Sockets.Num());
+	BakedMeshAsset = FSoftObjectPath(GetMeshAsset(Mesh));
+
+	for (const FName Socket : Sockets)
+	{
+		if (!ResolveSocket(Mesh, Socket, BakedSockets.AddDefaulted_GetRef()))
+		{
+			LOG_WARNING("Socket '%s' doesn't exist in %s of %s.", *Socket.ToString(), *GetNameSafe(Mesh), *GetPathName());
+			bAllSocketsValid = false;
+		}
+	}
+
+	if (!ResolveSocket(Mesh, FocusPointCustomSocket, BakedFocusPointSocket) && FocusPoint == EFocusPoint::CustomSocket)
+	{
+		LOG_WARNING("FocusPointCustomSocket '%s' doesn't exist in %s of %s.", *FocusPointCustomSocket.ToString(), *GetNameSafe(Mesh), *GetPathName());
+		bAllSocketsValid = false;
+	}
+
+	return bAllSocketsValid;
+}
+
+USceneComponent* UTargetComponent::FindArchetypeMeshComponent() const
+{
+	const UBlueprintGeneratedClass* const BPGC = Cast<UBlueprintGeneratedClass>(GetOuter());
+
+	if (!BPGC || TrackedMeshName == NAME_None)
+	{
+		return nullptr;
+	}
+
+	//Inherited native components live in the CDO.
+	if (USceneComponent* const NativeMesh = FindComponentByName<UMeshComponent>(BPGC->GetDefaultObject<AActor>(), TrackedMeshName))
+	{
+		return NativeMesh;
+	}
+
+	//Components added in the Blueprint editor live in the SCS of the class hierarchy.
+	for (const UBlueprintGeneratedClass* Class = BPGC; Class; Class = Cast<UBlueprintGeneratedClass>(Class->GetSuperClass()))
+	{
+		if (const USimpleConstructionScript* const SCS = Class->SimpleConstructionScript)
+		{
+			for (const USCS_Node* const Node : SCS->GetAllNodes())
+			{
+				if (Node && Node->GetVariableName() == TrackedMeshName)
+				{
+					return Cast<UMeshComponent>(Node->ComponentTemplate);
+				}
+			}
+		}
+	}
+
+	return nullptr;
+}
+
+void UTargetComponent::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	Super::PreSave(ObjectSaveContext);
+
+	//Level instances have an owner with all components, while Blueprint archetypes don't.
+	if (const USceneComponent* const Mesh = GetOwner() ? FindMeshComponent() : FindArchetypeMeshComponent())
+	{
+		BakeSockets(Mesh);
+	}
+}
+
+#endif //WITH_EDITOR
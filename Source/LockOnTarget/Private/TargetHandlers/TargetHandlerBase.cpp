@@ -4,7 +4,11 @@
 #include "LockOnTargetDefines.h"
 #include "LockOnTargetComponent.h"
 
+#include "Engine/World.h"
+
 UTargetHandlerBase::UTargetHandlerBase()
+	: FindResultLifetime(0.15f)
+	, CachedFindResultTime(0.f)
 {
 	//Do something.
 }
@@ -26,7 +30,64 @@ void UTargetHandlerBase::HandleTargetException_Implementation(const FTargetInfo&
 	//Optional.
 }
 
+FTargetInfo UTargetHandlerBase::FindTargetWithProfile(const FTargetEvaluationProfile& Profile, FVector2D PlayerInput)
+{
+	return FindTarget(PlayerInput);
+}
+
 bool UTargetHandlerBase::IsTargetValid(const UTargetComponent* Target) const
 {
 	return GetLockOnTargetComponent() ? GetLockOnTargetComponent()->IsTargetValid(Target) : false;
 }
+
+void UTargetHandlerBase::OnTargetLocked(UTargetComponent* Target, FName Socket)
+{
+	Super::OnTargetLocked(Target, Socket);
+	ResetCachedFindResult();
+}
+
+/*******************************************************************************************/
+/******************************* Find Result Reuse *****************************************/
+/*******************************************************************************************/
+
+void UTargetHandlerBase::CacheFindResult(const FTargetInfo& Target)
+{
+	if (FindResultLifetime > 0.f && GetWorld())
+	{
+		CachedFindResult = Target;
+		CachedFindResultTime = GetWorld()->GetTimeSeconds();
+	}
+}
+
+FTargetInfo UTargetHandlerBase::ConsumeCachedFindResult()
+{
+	LOT_SCOPED_EVENT(TargetHandlerConsumeCachedResult, Green);
+
+	FTargetInfo Result = FTargetInfo::NULL_TARGET;
+
+	if (CachedFindResult != FTargetInfo::NULL_TARGET && GetWorld())
+	{
+		const bool bIsFresh = GetWorld()->GetTimeSeconds() - CachedFindResultTime <= FindResultLifetime;
+
+		if (bIsFresh && IsTargetValid(CachedFindResult.TargetComponent) && RevalidateTarget(CachedFindResult))
+		{
+			Result = CachedFindResult;
+		}
+
+		ResetCachedFindResult();
+	}
+
+	return Result;
+}
+
+void UTargetHandlerBase::ResetCachedFindResult()
+{
+	CachedFindResult = FTargetInfo::NULL_TARGET;
+	CachedFindResultTime = 0.f;
+}
+
+bool UTargetHandlerBase::RevalidateTarget(const FTargetInfo& Target)
+{
+	//Unknown requirements, so the full search is needed.
+	return false;
+}
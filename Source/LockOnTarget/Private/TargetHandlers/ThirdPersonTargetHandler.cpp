@@ -4,6 +4,11 @@
 #include "LockOnTargetComponent.h"
 #include "TargetComponent.h"
 #include "TargetManager.h"
+#include "LandscapeOcclusionSubsystem.h"
+#include "LockOnTargetGovernor.h"
+#include "LockOnTargetWatchdog.h"
+#include "LockOnTargetTrace.h"
+#include "LockOnTargetTelemetry.h"
 #include "LockOnTargetDefines.h"
 
 #include "CollisionQueryParams.h"
@@ -12,6 +17,11 @@
 #include "GameFramework/Pawn.h"
 #include "TimerManager.h"
 #include "Camera/CameraTypes.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/ScopeExit.h"
+#include "AIController.h"
+#include "Perception/AIPerceptionComponent.h"
+#include "Perception/AISense_Sight.h"
 
 UThirdPersonTargetHandler::UThirdPersonTargetHandler()
 	: AutoFindTargetFlags(0b00011111)
@@ -23,6 +33,8 @@ UThirdPersonTargetHandler::UThirdPersonTargetHandler()
 	, DistanceMaxFactor(2750.f)
 	, AngleMaxFactor(90.f)
 	, MinimumThreshold(0.035f)
+	, bClusterScoring(false)
+	, MinTargetsForClustering(32)
 	, bDistanceCheck(true)
 	, MinimumRadius(0.f)
 	, TargetCaptureRadiusModifier(1.f)
@@ -34,10 +46,25 @@ UThirdPersonTargetHandler::UThirdPersonTargetHandler()
 	, bRecentRenderCheck(true)
 	, RecentTolerance(0.1f)
 	, AngleRange(60.f)
+	, bTrackBestSocket(false)
+	, SocketTrackingInterval(0.25f)
+	, SocketSwitchHysteresis(0.15f)
 	, bLineOfSightCheck(true)
 	, LostTargetDelay(3.f)
 	, CheckInterval(0.1f)
+	, LineOfSightBatchSize(4)
+	, bLandscapeOcclusionCheck(false)
+	, LandscapeHeightTolerance(50.f)
+	, bUseAIPerceptionLineOfSight(false)
 	, LineOfSightCheckTimer(0.f)
+	, SocketTrackingTimer(0.f)
+	, bDeferLineOfSight(false)
+	, CurrentCandidateIndex(INDEX_NONE)
+	, ActiveProfile(nullptr)
+	, WatchdogCapture(nullptr)
+	, SearchCandidatesNum(0)
+	, SearchTracesNum(0)
+	, LastCandidatesTime(0.0)
 {
 	TraceObjectChannels.Emplace(ECollisionChannel::ECC_WorldStatic);
 }
@@ -53,13 +80,34 @@ FTargetInfo UThirdPersonTargetHandler::FindTarget_Implementation(FVector2D Playe
 	return FindTargetInternal(Context);
 }
 
+FTargetInfo UThirdPersonTargetHandler::FindTargetWithProfile(const FTargetEvaluationProfile& Profile, FVector2D PlayerInput)
+{
+	TGuardValue<const FTargetEvaluationProfile*> ProfileGuard(ActiveProfile, &Profile);
+	return FindTarget(PlayerInput);
+}
+
 void UThirdPersonTargetHandler::CheckTargetState_Implementation(const FTargetInfo& Target, float DeltaTime)
 {
 	LOT_SCOPED_EVENT(TargetHandlerCheckState, Red);
 
+	ULockOnTargetWatchdog::FWatchScope WatchScope(ULockOnTargetWatchdog::Get(GetWorld()), TEXT("CheckTargetState"), this);
+	TGuardValue<FLockOnTargetWatchdogCapture*> CaptureGuard(WatchdogCapture, WatchScope.GetCapture());
+
+	//An automatic search caused by the check is recorded separately and doesn't affect the counters.
+	SearchCandidatesNum = 0;
+	SearchTracesNum = 0;
+	ULockOnTargetTelemetry::FRecordScope TelemetryScope(ULockOnTargetTelemetry::Get(GetWorld()), ELockOnTargetTelemetryCall::CheckTargetState, GetLockOnTargetComponent()->GetOwner()->GetActorLocation(), SearchCandidatesNum, SearchTracesNum);
+
 	FVector ViewLocation, ViewDirection;
 	GetPointOfView(ViewLocation, ViewDirection);
 
+	NoteWatchdogHookCall();
+
+	if (WatchdogCapture)
+	{
+		WatchdogCapture->ViewLocation = ViewLocation;
+	}
+
 	const AActor* const TargetActor = Target.TargetComponent->GetOwner();
 
 	if (bDistanceCheck)
@@ -80,16 +128,26 @@ void UThirdPersonTargetHandler::CheckTargetState_Implementation(const FTargetInf
 
 			return;
 		}
+
+		if (WatchdogCapture)
+		{
+			WatchdogCapture->MarkStage(TEXT("Distance"));
+		}
 	}
 
+	const FLockOnTargetSignificanceSettings& SignificanceSettings = ULockOnTargetGovernor::GetSignificanceSettings(GetLockOnTargetComponent());
+
 	//Line of Sight check.
-	if (bLineOfSightCheck && LostTargetDelay > 0.f)
+	if (bLineOfSightCheck && LostTargetDelay > 0.f && SignificanceSettings.bLineOfSight)
 	{
 		LineOfSightCheckTimer += DeltaTime;
 
-		if (LineOfSightCheckTimer > CheckInterval)
+		//The governor increases the interval under the load and for insignificant AI instigators.
+		const float ScaledCheckInterval = CheckInterval * ULockOnTargetGovernor::GetQualitySettings(GetWorld()).CheckIntervalScale * SignificanceSettings.CheckIntervalScale;
+
+		if (LineOfSightCheckTimer > ScaledCheckInterval)
 		{
-			LineOfSightCheckTimer -= CheckInterval;
+			LineOfSightCheckTimer -= ScaledCheckInterval;
 
 			if (LineOfSightTrace(ViewLocation, Target.TargetComponent->GetSocketLocation(Target.Socket), TargetActor))
 			{
@@ -100,6 +158,27 @@ void UThirdPersonTargetHandler::CheckTargetState_Implementation(const FTargetInf
 				StartLineOfSightTimer();
 			}
 		}
+
+		if (WatchdogCapture)
+		{
+			WatchdogCapture->MarkStage(TEXT("LineOfSight"));
+		}
+	}
+
+	if (bTrackBestSocket)
+	{
+		SocketTrackingTimer += DeltaTime;
+
+		if (SocketTrackingTimer > SocketTrackingInterval)
+		{
+			SocketTrackingTimer -= SocketTrackingInterval;
+			UpdateTrackedSocket(Target);
+
+			if (WatchdogCapture)
+			{
+				WatchdogCapture->MarkStage(TEXT("SocketTracking"));
+			}
+		}
 	}
 }
 
@@ -113,12 +192,51 @@ void UThirdPersonTargetHandler::HandleTargetException_Implementation(const FTarg
 	}
 }
 
+bool UThirdPersonTargetHandler::RevalidateTarget(const FTargetInfo& Target)
+{
+	LOT_SCOPED_EVENT(TargetHandlerRevalidateTarget, Green);
+
+	static const FName FindTargetName = GET_FUNCTION_NAME_CHECKED(UThirdPersonTargetHandler, FindTarget);
+
+	//The overridden search may have requirements unknown here.
+	if (GetClass()->IsFunctionImplementedInScript(FindTargetName))
+	{
+		return false;
+	}
+
+	if (!IsTargetValid(Target.TargetComponent) || !Target.TargetComponent->GetSockets().Contains(Target.Socket))
+	{
+		return false;
+	}
+
+	//The same checks as FindTargetInternal() runs for each candidate, including the Blueprint overrides.
+	FFindTargetContext Context = CreateFindTargetContext(EContextMode::Find);
+	Context.IteratorTarget.Target = Target.TargetComponent;
+
+	if (!IsTargetable(Context))
+	{
+		return false;
+	}
+
+	PrepareTargetContext(Context, Context.IteratorTarget, Target.Socket);
+	UpdateContext(Context);
+
+	if (!PreModifierCalculationCheck(Context))
+	{
+		return false;
+	}
+
+	NoteWatchdogHookCall();
+	return PostModifierCalculationCheck(Context);
+}
+
 void UThirdPersonTargetHandler::OnTargetUnlocked(UTargetComponent* UnlockedTarget, FName Socket)
 {
 	Super::OnTargetUnlocked(UnlockedTarget, Socket);
 
 	StopLineOfSightTimer();
 	LineOfSightCheckTimer = 0.f;
+	SocketTrackingTimer = 0.f;
 }
 
 /*******************************************************************************************/
@@ -194,6 +312,16 @@ void UThirdPersonTargetHandler::UpdateContext(FFindTargetContext& Context)
 
 void UThirdPersonTargetHandler::TryFindAndSetNewTarget(bool bClearTargetIfFailed)
 {
+	if (!GetLockOnTargetComponent()->ConsumeSearchAllowance())
+	{
+		if (bClearTargetIfFailed)
+		{
+			GetLockOnTargetComponent()->ClearTargetManual();
+		}
+
+		return;
+	}
+
 	FFindTargetContext Context = CreateFindTargetContext(EContextMode::Find);
 
 	const FTargetInfo Target = FindTargetInternal(Context);
@@ -210,25 +338,310 @@ void UThirdPersonTargetHandler::TryFindAndSetNewTarget(bool bClearTargetIfFailed
 
 FTargetInfo UThirdPersonTargetHandler::FindTargetInternal(FFindTargetContext& TargetContext)
 {
-	//@TODO: Try batching, don't process each Target individually. Store all Target in an array and run ~4 passes: IsTargetable, PreCheck, ModCalc, PostCheck.
-
 	LOT_SCOPED_EVENT(TargetHandlerFindTarget, Red);
 
-	FTargetModifier BestTarget{ FTargetInfo::NULL_TARGET, FLT_MAX };
+	ULockOnTargetWatchdog::FWatchScope WatchScope(ULockOnTargetWatchdog::Get(GetWorld()), TEXT("FindTarget"), this);
+	TGuardValue<FLockOnTargetWatchdogCapture*> CaptureGuard(WatchdogCapture, WatchScope.GetCapture());
+
+	if (WatchdogCapture)
+	{
+		WatchdogCapture->ViewLocation = TargetContext.ViewLocation;
+	}
+
+	//The search may be nested in the check, whose counters are restored after the search is recorded.
+	TGuardValue<int32> CandidatesGuard(SearchCandidatesNum, 0);
+	TGuardValue<int32> TracesGuard(SearchTracesNum, 0);
+	ULockOnTargetTelemetry::FRecordScope TelemetryScope(ULockOnTargetTelemetry::Get(GetWorld()), ELockOnTargetTelemetryCall::FindTarget, GetLockOnTargetComponent()->GetOwner()->GetActorLocation(), SearchCandidatesNum, SearchTracesNum);
+
+#if LOT_TRACE_ENABLED
+	//On success the winner is left in the candidates.
+	const uint64 SearchStartCycle = FPlatformTime::Cycles64();
+	ON_SCOPE_EXIT{ LOT_TRACE_SEARCH(GetLockOnTargetComponent(), SearchStartCycle, SearchCandidatesNum, SearchTracesNum, !Candidates.IsEmpty()); };
+#endif
+
+	//Nothing found if no candidate is gathered.
+	LastCandidates.Reset();
+	LastCandidatesTime = GetWorld()->GetTimeSeconds();
+
+	if (CanUseClusterScoring())
+	{
+		return FindTargetInClusters(TargetContext);
+	}
+
+	Candidates.Reset();
+
+	//Iterated by index, as the Targets may be (un)registered from the overridden checks.
+	const UTargetManager& TargetManager = UTargetManager::Get(*GetWorld());
+	const int32 TargetsNum = TargetManager.GetTargetsNum();
 
-	for (UTargetComponent* const Target : UTargetManager::Get(*GetWorld()).GetAllTargets())
+	for (int32 i = 0; i < TargetsNum; ++i)
 	{
 		LOT_SCOPED_EVENT(TargetHandlerTargetCalculation, Orange);
 
+		UTargetComponent* const Target = TargetManager.GetTargetAt(i);
+
+		if (!Target)
+		{
+			break;
+		}
+
 		TargetContext.IteratorTarget.Target = Target;
 
 		if (IsTargetable(TargetContext))
 		{
-			FindBestSocket(BestTarget, TargetContext);
+			GatherSocketCandidates(TargetContext);
+		}
+	}
+
+	//Stable to keep the iteration order for equal modifiers.
+	Candidates.StableSort([](const FTargetCandidate& Lhs, const FTargetCandidate& Rhs) { return Lhs.Modifier < Rhs.Modifier; });
+
+	if (WatchdogCapture)
+	{
+		WatchdogCapture->MarkStage(TEXT("Gather"));
+		RecordWatchdogCandidates();
+	}
+
+	RecordLastCandidates();
+	const bool bFound = SelectBestCandidate(TargetContext);
+
+	if (WatchdogCapture)
+	{
+		WatchdogCapture->MarkStage(TEXT("Select"));
+	}
+
+	return bFound ? Candidates[0].Target : FTargetInfo::NULL_TARGET;
+}
+
+void UThirdPersonTargetHandler::RecordWatchdogCandidates() const
+{
+	WatchdogCapture->Candidates.Reset(Candidates.Num());
+
+	for (const FTargetCandidate& Candidate : Candidates)
+	{
+		WatchdogCapture->Candidates.Add({ GetNameSafe(Candidate.Target.Target ? Candidate.Target.Target->GetOwner() : nullptr), Candidate.Target.Socket, Candidate.Target.Location, Candidate.Modifier });
+	}
+}
+
+void UThirdPersonTargetHandler::RecordLastCandidates()
+{
+	LastCandidates.Reset(Candidates.Num());
+
+	for (const FTargetCandidate& Candidate : Candidates)
+	{
+		LastCandidates.Add(Candidate.Target);
+	}
+}
+
+void UThirdPersonTargetHandler::NoteWatchdogHookCall() const
+{
+	if (WatchdogCapture)
+	{
+		++WatchdogCapture->BlueprintHookCalls;
+	}
+}
+
+void UThirdPersonTargetHandler::NoteTracesIssued(int32 NumTraces) const
+{
+	SearchTracesNum += NumTraces;
+
+	if (WatchdogCapture)
+	{
+		WatchdogCapture->TracesIssued += NumTraces;
+	}
+
+	LOT_TRACE_LINE_OF_SIGHT_TRACES(GetLockOnTargetComponent(), NumTraces);
+}
+
+bool UThirdPersonTargetHandler::CanUseClusterScoring() const
+{
+	return bClusterScoring
+		&& UTargetManager::Get(*GetWorld()).GetTargetsNum() >= MinTargetsForClustering
+		&& SupportsClusterScoring();
+}
+
+bool UThirdPersonTargetHandler::SupportsClusterScoring() const
+{
+	static const FName CalculateModifierName = GET_FUNCTION_NAME_CHECKED(UThirdPersonTargetHandler, CalculateTargetModifier);
+
+	//Blueprint subclasses share the native scoring unless they override the modifier.
+	const UClass* NativeClass = GetClass();
+
+	while (NativeClass && !NativeClass->HasAnyClassFlags(CLASS_Native))
+	{
+		NativeClass = NativeClass->GetSuperClass();
+	}
+
+	return NativeClass == UThirdPersonTargetHandler::StaticClass() && !GetClass()->IsFunctionImplementedInScript(CalculateModifierName);
+}
+
+FTargetInfo UThirdPersonTargetHandler::FindTargetInClusters(FFindTargetContext& TargetContext)
+{
+	LOT_SCOPED_EVENT(TargetHandlerFindTargetInClusters, Red);
+
+	//Clusters are referenced by the cell, as the overridden checks may (un)register Targets and change the clusters.
+	using FClusterBound = TPair<float, FIntVector>;
+	TArray<FClusterBound, TInlineAllocator<64>> ClusterBounds;
+	const TMap<FIntVector, FTargetCluster>& Clusters = UTargetManager::Get(*GetWorld()).GetClusters();
+
+	for (const auto& [Cell, Cluster] : Clusters)
+	{
+		//Skip clusters that are entirely outside the biggest CaptureRadius.
+		if (bDistanceCheck)
+		{
+			const float MaxRadius = Cluster.MaxCaptureRadius * TargetCaptureRadiusModifier + Cluster.Radius;
+
+			if (FVector::DistSquared(Cluster.Center, TargetContext.ViewLocation) > FMath::Square(MaxRadius))
+			{
+				continue;
+			}
+		}
+
+		ClusterBounds.Emplace(CalculateClusterModifierLowerBound(TargetContext, Cluster), Cell);
+	}
+
+	ClusterBounds.Sort([](const FClusterBound& Lhs, const FClusterBound& Rhs) { return Lhs.Key < Rhs.Key; });
+
+	if (WatchdogCapture)
+	{
+		WatchdogCapture->MarkStage(TEXT("ClusterBounds"));
+	}
+
+	Candidates.Reset();
+	int32 NextCluster = 0;
+
+	auto ExpandCluster = [this, &TargetContext, &ClusterBounds, &Clusters, &NextCluster]()
+	{
+		LOT_SCOPED_EVENT(TargetHandlerExpandCluster, Orange);
+
+		const FIntVector& Cell = ClusterBounds[NextCluster++].Value;
+		const FTargetCluster* Cluster = Clusters.Find(Cell);
+		const int32 MembersNum = Cluster ? Cluster->Members.Num() : 0;
+
+		for (int32 i = 0; i < MembersNum; ++i)
+		{
+			//The cluster may be changed or removed by the previous member's checks.
+			Cluster = Clusters.Find(Cell);
+
+			if (!Cluster || !Cluster->Members.IsValidIndex(i))
+			{
+				break;
+			}
+
+			UTargetComponent* const Target = Cluster->Members[i];
+			TargetContext.IteratorTarget.Target = Target;
+
+			if (IsTargetable(TargetContext))
+			{
+				GatherSocketCandidates(TargetContext);
+			}
+		}
+	};
+
+	auto GetBestModifier = [this]()
+	{
+		float BestModifier = FLT_MAX;
+
+		for (const FTargetCandidate& Candidate : Candidates)
+		{
+			BestModifier = FMath::Min(BestModifier, Candidate.Modifier);
+		}
+
+		return BestModifier;
+	};
+
+	while (true)
+	{
+		//Expand clusters until there is something to check.
+		while (Candidates.IsEmpty() && NextCluster < ClusterBounds.Num())
+		{
+			ExpandCluster();
+		}
+
+		if (Candidates.IsEmpty())
+		{
+			break;
+		}
+
+		//Then all clusters that may beat the best candidate.
+		while (NextCluster < ClusterBounds.Num() && ClusterBounds[NextCluster].Key < GetBestModifier())
+		{
+			ExpandCluster();
+		}
+
+		Candidates.StableSort([](const FTargetCandidate& Lhs, const FTargetCandidate& Rhs) { return Lhs.Modifier < Rhs.Modifier; });
+
+		if (WatchdogCapture)
+		{
+			WatchdogCapture->MarkStage(TEXT("ExpandClusters"));
+			RecordWatchdogCandidates();
+		}
+
+		RecordLastCandidates();
+		const bool bFound = SelectBestCandidate(TargetContext);
+
+		if (WatchdogCapture)
+		{
+			WatchdogCapture->MarkStage(TEXT("Select"));
+		}
+
+		//The winner is final only if no unexpanded cluster can beat it. Otherwise those clusters are expanded and the winner is rechecked.
+		if (bFound && (NextCluster >= ClusterBounds.Num() || ClusterBounds[NextCluster].Key >= Candidates[0].Modifier))
+		{
+			return Candidates[0].Target;
+		}
+
+		//The winner isn't checked again if it stays the best after the expansion.
+		if (bFound)
+		{
+			Candidates[0].bVerified = true;
 		}
 	}
 
-	return BestTarget.Key;
+	return FTargetInfo::NULL_TARGET;
+}
+
+float UThirdPersonTargetHandler::CalculateClusterModifierLowerBound(const FFindTargetContext& TargetContext, const FTargetCluster& Cluster) const
+{
+	//Mirrors CalculateTargetModifier_Implementation() with the least possible ratio of each factor within the cluster sphere.
+	float FinalModifier = PureDefaultModifier;
+
+	auto ApplyFactor = [&FinalModifier, this](float Weight, float Ratio)
+	{
+		const float Factor = FMath::Clamp(Ratio, MinimumThreshold, 1.f);
+		FinalModifier = FinalModifier * (1.f - Weight) + FinalModifier * Weight * Factor;
+	};
+
+	const FVector ToCenter = Cluster.Center - TargetContext.ViewLocation;
+	const float Distance = ToCenter.Size();
+
+	if (DistanceWeight > WeightPrecision)
+	{
+		const float Ratio = FMath::Square(FMath::Max(Distance - Cluster.Radius, 0.f)) / FMath::Square(DistanceMaxFactor);
+		ApplyFactor(DistanceWeight, Ratio);
+	}
+
+	if (AngleWeight > WeightPrecision)
+	{
+		float Ratio = 0.f;
+
+		if (Distance > Cluster.Radius)
+		{
+			const FVector ContextDirection = TargetContext.Mode == EContextMode::Find ? TargetContext.ViewDirectionWithOffset : TargetContext.CapturedTarget.Direction;
+			const float AngleToCenter = FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(ToCenter / Distance | ContextDirection, -1.f, 1.f)));
+			const float AngularRadius = FMath::RadiansToDegrees(FMath::Asin(Cluster.Radius / Distance));
+			Ratio = FMath::Max(AngleToCenter - AngularRadius, 0.f) / AngleMaxFactor;
+		}
+
+		ApplyFactor(AngleWeight, Ratio);
+	}
+
+	if (TargetContext.Mode == EContextMode::Switch && PlayerInputWeight > WeightPrecision)
+	{
+		ApplyFactor(PlayerInputWeight, 0.f);
+	}
+
+	return FinalModifier;
 }
 
 bool UThirdPersonTargetHandler::IsTargetable(const FFindTargetContext& TargetContext) const
@@ -266,6 +679,7 @@ bool UThirdPersonTargetHandler::IsTargetable(const FFindTargetContext& TargetCon
 		}
 	}
 
+	NoteWatchdogHookCall();
 	return IsTargetableCustom(Target);
 }
 
@@ -275,9 +689,13 @@ bool UThirdPersonTargetHandler::IsTargetableCustom_Implementation(const UTargetC
 	return true;
 }
 
-void UThirdPersonTargetHandler::FindBestSocket(FTargetModifier& BestTarget, FFindTargetContext& TargetContext)
+void UThirdPersonTargetHandler::GatherSocketCandidates(FFindTargetContext& TargetContext)
 {
-	for (const FName TargetSocket : TargetContext.IteratorTarget.Target->GetSockets())
+	const TArray<FName>& Sockets = TargetContext.IteratorTarget.Target->GetSockets();
+
+	const int32 SocketsNum = ShouldUseRepresentativeSocketOnly() ? FMath::Min(Sockets.Num(), 1) : Sockets.Num();
+
+	for (const FName TargetSocket : MakeArrayView(Sockets.GetData(), SocketsNum))
 	{
 		LOT_SCOPED_EVENT(TargetHandlerProcessSocket, Red);
 
@@ -292,18 +710,107 @@ void UThirdPersonTargetHandler::FindBestSocket(FTargetModifier& BestTarget, FFin
 
 		if (PreModifierCalculationCheck(TargetContext))
 		{
+			NoteWatchdogHookCall();
 			const float CurrentModifier = CalculateTargetModifier(TargetContext);
 
 			//Basically used by FGDC_LockOnTarget to visualize all modifiers.
 			OnModifierCalculated.Broadcast(TargetContext, CurrentModifier);
 
-			if (CurrentModifier < BestTarget.Value && PostModifierCalculationCheck(TargetContext))
+			Candidates.Add({ TargetContext.IteratorTarget, TargetContext.DeltaAngle2D, CurrentModifier });
+			++SearchCandidatesNum;
+		}
+	}
+}
+
+bool UThirdPersonTargetHandler::SelectBestCandidate(FFindTargetContext& TargetContext)
+{
+	LOT_SCOPED_EVENT(TargetHandlerSelectCandidate, Yellow);
+
+	//Without the Line of Sight there is nothing to batch, so candidates are checked one by one.
+	const int32 BatchSize = ShouldTraceCandidates() ? FMath::Max(LineOfSightBatchSize, 1) : 1;
+	TArray<bool, TInlineAllocator<16>> PassedChecks;
+
+	//The governor may cap the number of checked candidates under the load.
+	const int32 MaxLineOfSightChecks = ULockOnTargetGovernor::GetQualitySettings(GetWorld()).MaxLineOfSightChecks;
+	const int32 CandidatesToCheck = ShouldTraceCandidates() && MaxLineOfSightChecks > 0 ? FMath::Min(Candidates.Num(), MaxLineOfSightChecks) : Candidates.Num();
+
+	//Otherwise only the candidates that passed the rest of the checks are traced, best first, until one is visible.
+	const bool bTraceWinnersOnly = bLineOfSightCheck && ActiveProfile && ActiveProfile->LineOfSight == ELineOfSightEvaluation::WinnerOnly;
+	int32 WinnerTraces = 0;
+
+	for (int32 BatchStart = 0; BatchStart < CandidatesToCheck; BatchStart += BatchSize)
+	{
+		const int32 BatchEnd = FMath::Min(BatchStart + BatchSize, CandidatesToCheck);
+
+		PendingLineOfSightRays.Reset();
+		PassedChecks.Reset();
+
+		{
+			TGuardValue<bool> DeferGuard(bDeferLineOfSight, true);
+			ON_SCOPE_EXIT{ CurrentCandidateIndex = INDEX_NONE; };
+
+			for (int32 i = BatchStart; i < BatchEnd; ++i)
+			{
+				if (Candidates[i].bVerified)
+				{
+					PassedChecks.Add(true);
+					continue;
+				}
+
+				CurrentCandidateIndex = i;
+				TargetContext.IteratorTarget = Candidates[i].Target;
+				TargetContext.DeltaAngle2D = Candidates[i].DeltaAngle2D;
+				NoteWatchdogHookCall();
+				PassedChecks.Add(PostModifierCalculationCheck(TargetContext));
+			}
+		}
+
+		LineOfSightTraceBatch(PendingLineOfSightRays);
+
+		for (const FLineOfSightRay& Ray : PendingLineOfSightRays)
+		{
+			if (!Ray.bIsClear && PassedChecks.IsValidIndex(Ray.CandidateIndex - BatchStart))
 			{
-				BestTarget.Key = TargetContext.IteratorTarget;
-				BestTarget.Value = CurrentModifier;
+				PassedChecks[Ray.CandidateIndex - BatchStart] = false;
 			}
 		}
+
+		for (int32 i = BatchStart; i < BatchEnd; ++i)
+		{
+			if (!PassedChecks[i - BatchStart])
+			{
+				continue;
+			}
+
+			if (bTraceWinnersOnly && !Candidates[i].bVerified)
+			{
+				if (MaxLineOfSightChecks > 0 && WinnerTraces >= MaxLineOfSightChecks)
+				{
+					break;
+				}
+
+				++WinnerTraces;
+				const FTargetContext& Target = Candidates[i].Target;
+
+				if (!LineOfSightTrace(TargetContext.ViewLocation, Target.Location, Target.Target->GetOwner()))
+				{
+					continue;
+				}
+			}
+
+			//All previous candidates have failed.
+			Candidates.RemoveAt(0, i, false);
+			return true;
+		}
+
+		if (bTraceWinnersOnly && MaxLineOfSightChecks > 0 && WinnerTraces >= MaxLineOfSightChecks)
+		{
+			break;
+		}
 	}
+
+	Candidates.Reset();
+	return false;
 }
 
 bool UThirdPersonTargetHandler::PreModifierCalculationCheck(const FFindTargetContext& TargetContext) const
@@ -320,7 +827,7 @@ bool UThirdPersonTargetHandler::PreModifierCalculationCheck(const FFindTargetCon
 	}
 
 	//Cone view check.
-	if (!bScreenCapture)
+	if (!ShouldUseScreenCapture())
 	{
 		//@TODO: Look at AIHelpers.h CheckIsTargetInSightCone().
 		const float Product = TargetContext.ViewDirection | TargetContext.IteratorTarget.Direction;
@@ -376,7 +883,7 @@ bool UThirdPersonTargetHandler::PostModifierCalculationCheck_Implementation(cons
 	LOT_SCOPED_EVENT(TargetHandlerPostCheck, Yellow);
 
 	//Visibility check.
-	if (bScreenCapture && IsValid(TargetContext.PlayerController))
+	if (ShouldUseScreenCapture() && IsValid(TargetContext.PlayerController))
 	{
 		FVector2D ScreenPosition;
 
@@ -388,9 +895,14 @@ bool UThirdPersonTargetHandler::PostModifierCalculationCheck_Implementation(cons
 	}
 
 	//LineOfSight check
-	if (bLineOfSightCheck)
+	if (ShouldTraceCandidates())
 	{
-		if (!LineOfSightTrace(TargetContext.ViewLocation, TargetContext.IteratorTarget.Location, TargetContext.IteratorTarget.Target->GetOwner()))
+		if (bDeferLineOfSight)
+		{
+			//Will be traced with the whole batch by SelectBestCandidate().
+			PendingLineOfSightRays.Add({ TargetContext.ViewLocation, TargetContext.IteratorTarget.Location, TargetContext.IteratorTarget.Target->GetOwner(), CurrentCandidateIndex });
+		}
+		else if (!LineOfSightTrace(TargetContext.ViewLocation, TargetContext.IteratorTarget.Location, TargetContext.IteratorTarget.Target->GetOwner()))
 		{
 			return false;
 		}
@@ -399,6 +911,67 @@ bool UThirdPersonTargetHandler::PostModifierCalculationCheck_Implementation(cons
 	return true;
 }
 
+/*******************************************************************************************/
+/*******************************  Socket Tracking  *****************************************/
+/*******************************************************************************************/
+
+void UThirdPersonTargetHandler::UpdateTrackedSocket(const FTargetInfo& Target)
+{
+	LOT_SCOPED_EVENT(TargetHandlerTrackSocket, Orange);
+
+	if (!IsValid(Target.TargetComponent) || Target.TargetComponent->GetSockets().Num() < 2)
+	{
+		return;
+	}
+
+	//Sockets are scored as if a new Target is being found, i.e. relative to the view direction.
+	FFindTargetContext Context = CreateFindTargetContext(EContextMode::Find);
+	Context.IteratorTarget.Target = Target.TargetComponent;
+
+	FTargetContext BestSocket;
+	float BestModifier = FLT_MAX;
+	float CapturedModifier = FLT_MAX;
+
+	for (const FName Socket : Target.TargetComponent->GetSockets())
+	{
+		PrepareTargetContext(Context, Context.IteratorTarget, Socket);
+
+		//The same order as while finding a Target. The captured Socket is the baseline, so it isn't rejected.
+		const bool bIsCapturedSocket = Socket == Target.Socket;
+
+		if (!bIsCapturedSocket && !PreModifierCalculationCheck(Context))
+		{
+			continue;
+		}
+
+		NoteWatchdogHookCall();
+		const float Modifier = CalculateTargetModifier(Context);
+
+		if (bIsCapturedSocket)
+		{
+			CapturedModifier = Modifier;
+		}
+		else if (Modifier < BestModifier)
+		{
+			BestSocket = Context.IteratorTarget;
+			BestModifier = Modifier;
+		}
+	}
+
+	if (BestModifier < CapturedModifier * (1.f - SocketSwitchHysteresis))
+	{
+		Context.IteratorTarget = BestSocket;
+
+		//Only the switch candidate pays for the expensive checks.
+		NoteWatchdogHookCall();
+
+		if (PostModifierCalculationCheck(Context))
+		{
+			GetLockOnTargetComponent()->SetLockOnTargetManualByInfo(BestSocket);
+		}
+	}
+}
+
 /*******************************************************************************************/
 /*******************************  Line Of Sight  *******************************************/
 /*******************************************************************************************/
@@ -408,6 +981,7 @@ void UThirdPersonTargetHandler::StartLineOfSightTimer()
 	if (GetWorld() && !GetWorld()->GetTimerManager().IsTimerActive(LineOfSightExpirationHandle))
 	{
 		GetWorld()->GetTimerManager().SetTimer(LineOfSightExpirationHandle, FTimerDelegate::CreateUObject(this, &UThirdPersonTargetHandler::OnLineOfSightExpiration), LostTargetDelay, false);
+		LOT_TRACE_LINE_OF_SIGHT_TIMER(GetLockOnTargetComponent(), true);
 	}
 }
 
@@ -415,12 +989,18 @@ void UThirdPersonTargetHandler::StopLineOfSightTimer()
 {
 	if (const UWorld* const World = GetWorld())
 	{
-		World->GetTimerManager().ClearTimer(LineOfSightExpirationHandle);
+		if (World->GetTimerManager().IsTimerActive(LineOfSightExpirationHandle))
+		{
+			World->GetTimerManager().ClearTimer(LineOfSightExpirationHandle);
+			LOT_TRACE_LINE_OF_SIGHT_TIMER(GetLockOnTargetComponent(), false);
+		}
 	}
 }
 
 void UThirdPersonTargetHandler::OnLineOfSightExpiration()
 {
+	LOT_TRACE_LINE_OF_SIGHT_TIMER(GetLockOnTargetComponent(), false);
+
 	if (IsAnyUnlockReasonSet(AutoFindTargetFlags, EUnlockReason::LineOfSightFail))
 	{
 		TryFindAndSetNewTarget(true);
@@ -440,12 +1020,16 @@ bool UThirdPersonTargetHandler::LineOfSightTrace(const FVector& From, const FVec
 		return false;
 	}
 
-	FHitResult HitRes;
-	FCollisionObjectQueryParams ObjParams;
+	bool bIsPerceived = false;
 
-	for (const auto& TraceChannel : TraceObjectChannels)
+	if (GetPerceivedLineOfSight(TargetToIgnore, bIsPerceived))
 	{
-		ObjParams.AddObjectTypesToQuery(TraceChannel);
+		return bIsPerceived;
+	}
+
+	if (IsBlockedByLandscape(From, To))
+	{
+		return false;
 	}
 
 	//SCENE QUERY PARAMS for the debug. Tag = LockOnTrace. In the console print TraceTag<LockOnTrace> or TraceTagAll
@@ -453,15 +1037,132 @@ bool UThirdPersonTargetHandler::LineOfSightTrace(const FVector& From, const FVec
 	CollisionParams.AddIgnoredActor(TargetToIgnore);
 	CollisionParams.AddIgnoredActor(GetLockOnTargetComponent()->GetOwner());
 
-	GetWorld()->LineTraceSingleByObjectType(HitRes, From, To, ObjParams, CollisionParams);
+	NoteTracesIssued(1);
 
-	return !HitRes.bBlockingHit;
+	//Any hit fails the Line of Sight, so the hit result isn't needed.
+	return !GetWorld()->LineTraceTestByObjectType(From, To, MakeLineOfSightObjectParams(), CollisionParams);
+}
+
+FCollisionObjectQueryParams UThirdPersonTargetHandler::MakeLineOfSightObjectParams() const
+{
+	FCollisionObjectQueryParams ObjectParams;
+
+	for (const auto& TraceChannel : TraceObjectChannels)
+	{
+		ObjectParams.AddObjectTypesToQuery(TraceChannel);
+	}
+
+	return ObjectParams;
+}
+
+void UThirdPersonTargetHandler::LineOfSightTraceBatch(TArrayView<FLineOfSightRay> Rays) const
+{
+	LOT_SCOPED_EVENT(TargetHandlerLineOfSightBatch, Yellow);
+
+	const UWorld* const World = GetWorld();
+
+	if (Rays.IsEmpty() || !World)
+	{
+		return;
+	}
+
+	//The filters are built once per batch and copied for each ray, as only the ignored Target differs.
+	const FCollisionObjectQueryParams ObjectParams = MakeLineOfSightObjectParams();
+	FCollisionQueryParams SharedParams(SCENE_QUERY_STAT(LockOnTrace));
+	SharedParams.AddIgnoredActor(GetLockOnTargetComponent()->GetOwner());
+
+	//A batch is only a few rays, which don't pay off the task dispatch and would contend on the scene lock if traced in parallel.
+	for (FLineOfSightRay& Ray : Rays)
+	{
+		if (!Ray.TargetToIgnore || GetPerceivedLineOfSight(Ray.TargetToIgnore, Ray.bIsClear))
+		{
+			continue;
+		}
+
+		if (IsBlockedByLandscape(Ray.From, Ray.To))
+		{
+			Ray.bIsClear = false;
+			continue;
+		}
+
+		NoteTracesIssued(1);
+
+		FCollisionQueryParams CollisionParams = SharedParams;
+		CollisionParams.AddIgnoredActor(Ray.TargetToIgnore);
+
+		Ray.bIsClear = !World->LineTraceTestByObjectType(Ray.From, Ray.To, ObjectParams, CollisionParams);
+	}
+}
+
+bool UThirdPersonTargetHandler::IsBlockedByLandscape(const FVector& From, const FVector& To) const
+{
+	if (bLandscapeOcclusionCheck)
+	{
+		if (ULandscapeOcclusionSubsystem* const LandscapeOcclusion = ULandscapeOcclusionSubsystem::Get(GetWorld()))
+		{
+			return LandscapeOcclusion->IsRayOccluded(From, To, LandscapeHeightTolerance);
+		}
+	}
+
+	return false;
+}
+
+bool UThirdPersonTargetHandler::GetPerceivedLineOfSight(const AActor* const TargetActor, bool& bOutIsVisible) const
+{
+	if (!bUseAIPerceptionLineOfSight || !TargetActor)
+	{
+		return false;
+	}
+
+	const AAIController* const AIController = Cast<AAIController>(GetController());
+	const UAIPerceptionComponent* const Perception = AIController ? AIController->GetPerceptionComponent() : nullptr;
+
+	if (!Perception)
+	{
+		return false;
+	}
+
+	const FActorPerceptionInfo* const PerceptionInfo = Perception->GetActorInfo(*TargetActor);
+	const FAISenseID SightID = UAISense::GetSenseID<UAISense_Sight>();
+
+	if (!PerceptionInfo || !SightID.IsValid() || !PerceptionInfo->LastSensedStimuli.IsValidIndex(SightID))
+	{
+		return false;
+	}
+
+	const FAIStimulus& SightStimulus = PerceptionInfo->LastSensedStimuli[SightID];
+
+	if (SightStimulus.GetAge() == FAIStimulus::NeverHappenedAge)
+	{
+		return false;
+	}
+
+	//The sight sense reports a failed stimulus once it loses the Target.
+	bOutIsVisible = SightStimulus.WasSuccessfullySensed();
+	return true;
 }
 
 /*******************************************************************************************/
 /*********************************** Helpers ***********************************************/
 /*******************************************************************************************/
 
+bool UThirdPersonTargetHandler::ShouldUseScreenCapture() const
+{
+	return bScreenCapture && !(ActiveProfile && ActiveProfile->bUseViewCone);
+}
+
+bool UThirdPersonTargetHandler::ShouldTraceCandidates() const
+{
+	return bLineOfSightCheck && !(ActiveProfile && ActiveProfile->LineOfSight != ELineOfSightEvaluation::Full)
+		&& ULockOnTargetGovernor::GetSignificanceSettings(GetLockOnTargetComponent()).bLineOfSight;
+}
+
+bool UThirdPersonTargetHandler::ShouldUseRepresentativeSocketOnly() const
+{
+	//The governor may limit the search to the first Socket under the load.
+	return (ActiveProfile && ActiveProfile->bRepresentativeSocketOnly) || ULockOnTargetGovernor::GetQualitySettings(GetWorld()).bRepresentativeSocketOnly;
+}
+
 bool UThirdPersonTargetHandler::IsTargetOnScreen(const APlayerController* const PlayerController, FVector2D ScreenPosition) const
 {
 	bool bResult = false;
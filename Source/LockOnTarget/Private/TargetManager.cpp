@@ -1,9 +1,24 @@
 // Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
 
 #include "TargetManager.h"
+#include "TargetComponent.h"
+#include "LockOnTargetComponent.h"
+#include "LockOnTargetDefines.h"
+
 #include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Components/SceneComponent.h"
+#include "GenericTeamAgentInterface.h"
 
 UTargetManager::UTargetManager()
+	: ClusterCellSize(1500.f)
+	, ClusterBoundsPadding(100.f)
+	, ClustersUpdateFrame(0)
+	, bClustersMaintained(false)
+	, FocusConsumerSerial(0)
+	, FocusUpdateFrame(0)
+	, FocusUpdateTime(0.0)
+	, bQueryEntriesMaintained(false)
 {
 	//Do something.
 }
@@ -18,6 +33,7 @@ void UTargetManager::OnWorldBeginPlay(UWorld& InWorld)
 {
 	Super::OnWorldBeginPlay(InWorld);
 	Targets.Reserve(20);
+	DenseTargets.Reserve(20);
 }
 
 bool UTargetManager::DoesSupportWorldType(const EWorldType::Type Type) const
@@ -32,6 +48,39 @@ bool UTargetManager::RegisterTarget(UTargetComponent* Target)
 	if (Target)
 	{
 		Targets.Add(Target, &bHasAlreadyBeen);
+
+		if (!bHasAlreadyBeen)
+		{
+			DenseTargets.Add(Target);
+
+			if (bClustersMaintained)
+			{
+				TrackClusterTarget(Target);
+			}
+
+			if (bQueryEntriesMaintained)
+			{
+				TrackQueryTarget(Target);
+			}
+
+#if LOT_COMPACT_TARGET_IDS
+			//Local Targets of the client aren't referenced over the network, but shouldn't take the server IDs.
+			if (Target->GetNetMode() != NM_Client)
+			{
+				//The ID never reaches the clients without replication, so such Targets are referenced by their owners.
+				const AActor* const Owner = Target->GetOwner();
+
+				if (Owner && Owner->GetIsReplicated() && Target->GetIsReplicated())
+				{
+					AssignNetTargetId(Target);
+				}
+			}
+			else
+			{
+				MapNetTargetId(Target);
+			}
+#endif
+		}
 	}
 
 	return !bHasAlreadyBeen;
@@ -39,5 +88,550 @@ bool UTargetManager::RegisterTarget(UTargetComponent* Target)
 
 bool UTargetManager::UnregisterTarget(UTargetComponent* Target)
 {
-	return Targets.Remove(Target) > 0;
+	if (bClustersMaintained)
+	{
+		UntrackClusterTarget(Target);
+	}
+
+	//Consumers stay registered and see the invalid sample.
+	for (auto It = FocusEntries.CreateIterator(); It; ++It)
+	{
+		if (It->Target == Target)
+		{
+			FocusEntryIndices.Remove({ Target, It->InstigatorKey });
+			It->Target = nullptr;
+			FocusSamples[It.GetIndex()].bValid = false;
+		}
+	}
+
+	if (bQueryEntriesMaintained)
+	{
+		UntrackQueryTarget(Target);
+	}
+
+	if (Targets.Remove(Target) > 0)
+	{
+		DenseTargets.RemoveSingleSwap(Target, false);
+
+#if LOT_COMPACT_TARGET_IDS
+		ReleaseNetTargetId(Target);
+#endif
+
+		return true;
+	}
+
+	return false;
+}
+
+void UTargetManager::GetTargetsPage(int32 StartIndex, int32 Count, TArray<UTargetComponent*>& OutTargets) const
+{
+	OutTargets.Reset();
+
+	const int32 First = FMath::Max(StartIndex, 0);
+	const int32 Last = static_cast<int32>(FMath::Min<int64>(static_cast<int64>(First) + FMath::Max(Count, 0), DenseTargets.Num()));
+
+	if (First < Last)
+	{
+		OutTargets.Append(DenseTargets.GetData() + First, Last - First);
+	}
+}
+
+/*******************************************************************************************/
+/*******************************  Clusters  ************************************************/
+/*******************************************************************************************/
+
+const TMap<FIntVector, FTargetCluster>& UTargetManager::GetClusters()
+{
+	if (!bClustersMaintained)
+	{
+		//From now on, the Targets report their movement.
+		bClustersMaintained = true;
+
+		for (UTargetComponent* const Target : DenseTargets)
+		{
+			TrackClusterTarget(Target);
+		}
+	}
+
+	if (ClustersUpdateFrame != GFrameCounter)
+	{
+		ClustersUpdateFrame = GFrameCounter;
+		UpdateClusters();
+	}
+
+	return Clusters;
+}
+
+void UTargetManager::TrackClusterTarget(UTargetComponent* Target)
+{
+	FClusteredTarget& Clustered = ClusteredTargets.Add(Target);
+
+	if (USceneComponent* const Root = Target->GetOwner()->GetRootComponent())
+	{
+		Clustered.Root = Root;
+		Clustered.TransformUpdatedHandle = Root->TransformUpdated.AddUObject(this, &ThisClass::OnClusterTargetMoved, Target);
+	}
+
+	Clustered.bDirty = true;
+	DirtyClusterTargets.Add(Target);
+}
+
+void UTargetManager::UntrackClusterTarget(UTargetComponent* Target)
+{
+	FClusteredTarget Clustered;
+
+	if (ClusteredTargets.RemoveAndCopyValue(Target, Clustered))
+	{
+		if (USceneComponent* const Root = Clustered.Root.Get())
+		{
+			Root->TransformUpdated.Remove(Clustered.TransformUpdatedHandle);
+		}
+
+		if (Clustered.bHasCell)
+		{
+			RemoveFromCluster(Target, Clustered.Cell);
+		}
+
+		if (Clustered.bDirty)
+		{
+			DirtyClusterTargets.RemoveSingleSwap(Target, false);
+		}
+	}
+}
+
+void UTargetManager::OnClusterTargetMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, UTargetComponent* Target)
+{
+	FClusteredTarget* const Clustered = ClusteredTargets.Find(Target);
+
+	if (Clustered && !Clustered->bDirty)
+	{
+		Clustered->bDirty = true;
+		DirtyClusterTargets.Add(Target);
+	}
+}
+
+void UTargetManager::UpdateClusters()
+{
+	LOT_SCOPED_EVENT(TargetManagerUpdateClusters, Blue);
+
+	const double CellSize = FMath::Max(ClusterCellSize, 1.f);
+
+	//Only the moved Targets are processed. Those which have changed the cell are moved between clusters.
+	for (UTargetComponent* const Target : DirtyClusterTargets)
+	{
+		FClusteredTarget& Clustered = ClusteredTargets.FindChecked(Target);
+		Clustered.bDirty = false;
+
+		const FVector Location = Target->GetOwner()->GetActorLocation();
+		const FIntVector NewCell(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize), FMath::FloorToInt32(Location.Z / CellSize));
+
+		if (!Clustered.bHasCell || Clustered.Cell != NewCell)
+		{
+			if (Clustered.bHasCell)
+			{
+				RemoveFromCluster(Target, Clustered.Cell);
+			}
+
+			Clustered.Cell = NewCell;
+			Clustered.bHasCell = true;
+			Clusters.FindOrAdd(NewCell).Members.Add(Target);
+		}
+
+		//Moving within the cell changes the bounds too.
+		TouchedClusterCells.Add(NewCell);
+	}
+
+	DirtyClusterTargets.Reset();
+
+	for (const FIntVector& Cell : TouchedClusterCells)
+	{
+		if (FTargetCluster* const Cluster = Clusters.Find(Cell))
+		{
+			RefreshClusterBounds(*Cluster, ClusterBoundsPadding);
+		}
+	}
+
+	TouchedClusterCells.Reset();
+}
+
+void UTargetManager::RefreshClusterBounds(FTargetCluster& Cluster, float Padding)
+{
+	FVector Center = FVector::ZeroVector;
+
+	for (const UTargetComponent* const Member : Cluster.Members)
+	{
+		Center += Member->GetOwner()->GetActorLocation();
+	}
+
+	Cluster.Center = Center / FMath::Max(Cluster.Members.Num(), 1);
+	Cluster.Radius = 0.f;
+	Cluster.MaxCaptureRadius = 0.f;
+
+	for (const UTargetComponent* const Member : Cluster.Members)
+	{
+		const FVector ActorLocation = Member->GetOwner()->GetActorLocation();
+		float MemberRadius = FVector::Dist(ActorLocation, Cluster.Center);
+
+		//Sockets are expected to be inside the tracked mesh bounds.
+		if (const USceneComponent* const Mesh = Member->GetTrackedMeshComponent())
+		{
+			MemberRadius = FMath::Max<float>(MemberRadius, FVector::Dist(Mesh->Bounds.Origin, Cluster.Center) + Mesh->Bounds.SphereRadius);
+		}
+
+		Cluster.Radius = FMath::Max(Cluster.Radius, MemberRadius);
+		Cluster.MaxCaptureRadius = FMath::Max(Cluster.MaxCaptureRadius, Member->CaptureRadius);
+	}
+
+	Cluster.Radius += FMath::Max(Padding, 0.f);
+}
+
+void UTargetManager::RemoveFromCluster(UTargetComponent* Target, const FIntVector& Cell)
+{
+	if (FTargetCluster* const Cluster = Clusters.Find(Cell))
+	{
+		Cluster->Members.RemoveSingleSwap(Target);
+
+		if (Cluster->Members.IsEmpty())
+		{
+			Clusters.Remove(Cell);
+		}
+		else
+		{
+			TouchedClusterCells.Add(Cell);
+		}
+	}
+}
+
+/*******************************************************************************************/
+/*******************************  Queries  *************************************************/
+/*******************************************************************************************/
+
+void UTargetManager::QueryTargets(const FTargetQuery& Query, TArray<FTargetQueryResult>& OutResults)
+{
+	TargetQuery::Execute(GetQueryEntries(), Query, OutResults);
+}
+
+TConstArrayView<FTargetQueryEntry> UTargetManager::GetQueryEntries()
+{
+	if (!bQueryEntriesMaintained)
+	{
+		//From now on, the Targets report their movement.
+		bQueryEntriesMaintained = true;
+
+		for (UTargetComponent* const Target : DenseTargets)
+		{
+			TrackQueryTarget(Target);
+		}
+	}
+
+	return QueryEntries;
+}
+
+void UTargetManager::RefreshQueryEntry(UTargetComponent* Target)
+{
+	if (const FQueryTarget* const QueryTarget = QueryTargetEntries.Find(Target))
+	{
+		CaptureQueryEntry(Target, QueryEntries[QueryTarget->EntryIndex]);
+	}
+}
+
+void UTargetManager::TrackQueryTarget(UTargetComponent* Target)
+{
+	FQueryTarget& QueryTarget = QueryTargetEntries.Add(Target);
+	QueryTarget.EntryIndex = QueryEntries.AddDefaulted();
+	CaptureQueryEntry(Target, QueryEntries[QueryTarget.EntryIndex]);
+
+	if (USceneComponent* const Root = Target->GetOwner()->GetRootComponent())
+	{
+		QueryTarget.Root = Root;
+		QueryTarget.TransformUpdatedHandle = Root->TransformUpdated.AddUObject(this, &ThisClass::OnQueryTargetMoved, Target);
+	}
+}
+
+void UTargetManager::UntrackQueryTarget(UTargetComponent* Target)
+{
+	FQueryTarget QueryTarget;
+
+	if (QueryTargetEntries.RemoveAndCopyValue(Target, QueryTarget))
+	{
+		if (USceneComponent* const Root = QueryTarget.Root.Get())
+		{
+			Root->TransformUpdated.Remove(QueryTarget.TransformUpdatedHandle);
+		}
+
+		QueryEntries.RemoveAtSwap(QueryTarget.EntryIndex, 1, false);
+
+		//The last entry has taken the place of the removed one.
+		if (QueryEntries.IsValidIndex(QueryTarget.EntryIndex))
+		{
+			QueryTargetEntries.FindChecked(QueryEntries[QueryTarget.EntryIndex].Target.Get()).EntryIndex = QueryTarget.EntryIndex;
+		}
+	}
+}
+
+void UTargetManager::OnQueryTargetMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, UTargetComponent* Target)
+{
+	if (const FQueryTarget* const QueryTarget = QueryTargetEntries.Find(Target))
+	{
+		QueryEntries[QueryTarget->EntryIndex].Location = UpdatedComponent->GetComponentLocation();
+	}
+}
+
+void UTargetManager::CaptureQueryEntry(UTargetComponent* Target, FTargetQueryEntry& Entry)
+{
+	LOT_SCOPED_EVENT(TargetManagerCaptureQueryEntry, Blue);
+
+	const AActor* const Owner = Target->GetOwner();
+
+	Entry.Target = Target;
+	Entry.Location = Owner->GetActorLocation();
+	Entry.Tags = Owner->Tags;
+	Entry.TeamId = FGenericTeamId::GetTeamIdentifier(Owner).GetId();
+	Entry.bCanBeCaptured = Target->CanBeCaptured();
+	Entry.bIsCaptured = Target->IsCaptured();
+}
+
+/*******************************************************************************************/
+/*******************************  Focus Consumers  *****************************************/
+/*******************************************************************************************/
+
+FTargetFocusHandle UTargetManager::RegisterFocusConsumer(UTargetComponent* Target, const ULockOnTargetComponent* Instigator)
+{
+	FTargetFocusHandle Handle;
+
+	if (!IsTargetRegistered(Target))
+	{
+		return Handle;
+	}
+
+	int32 EntryIndex = INDEX_NONE;
+
+	if (const int32* const ExistingIndex = FocusEntryIndices.Find({ Target, Instigator }))
+	{
+		//The key address may belong to a new Instigator.
+		EntryIndex = *ExistingIndex;
+		FocusEntries[EntryIndex].Instigator = Instigator;
+	}
+	else
+	{
+		EntryIndex = FocusEntries.Add({ Target, Instigator, Instigator, 0 });
+		FocusEntryIndices.Add({ Target, Instigator }, EntryIndex);
+
+		if (EntryIndex >= FocusSamples.Num())
+		{
+			FocusSamples.SetNum(EntryIndex + 1);
+		}
+
+		FocusSamples[EntryIndex] = FTargetFocusSample();
+	}
+
+	++FocusEntries[EntryIndex].NumConsumers;
+
+	Handle.Serial = ++FocusConsumerSerial;
+	Handle.Index = FocusConsumers.Add({ EntryIndex, Handle.Serial });
+
+	return Handle;
+}
+
+void UTargetManager::UnregisterFocusConsumer(FTargetFocusHandle& Handle)
+{
+	if (const FFocusConsumer* const Consumer = FindFocusConsumer(Handle))
+	{
+		const int32 EntryIndex = Consumer->EntryIndex;
+		FFocusEntry& Entry = FocusEntries[EntryIndex];
+
+		if (--Entry.NumConsumers <= 0)
+		{
+			if (Entry.Target)
+			{
+				FocusEntryIndices.Remove({ Entry.Target, Entry.InstigatorKey });
+			}
+
+			FocusEntries.RemoveAt(EntryIndex);
+			FocusSamples[EntryIndex] = FTargetFocusSample();
+		}
+
+		FocusConsumers.RemoveAt(Handle.Index);
+	}
+
+	Handle = FTargetFocusHandle();
+}
+
+const UTargetManager::FFocusConsumer* UTargetManager::FindFocusConsumer(const FTargetFocusHandle& Handle) const
+{
+	if (FocusConsumers.IsValidIndex(Handle.Index) && FocusConsumers[Handle.Index].Serial == Handle.Serial)
+	{
+		return &FocusConsumers[Handle.Index];
+	}
+
+	return nullptr;
+}
+
+int32 UTargetManager::GetFocusSampleIndex(const FTargetFocusHandle& Handle) const
+{
+	const FFocusConsumer* const Consumer = FindFocusConsumer(Handle);
+	return Consumer ? Consumer->EntryIndex : INDEX_NONE;
+}
+
+const FTargetFocusSample* UTargetManager::GetFocusSample(const FTargetFocusHandle& Handle)
+{
+	const int32 SampleIndex = GetFocusSampleIndex(Handle);
+	return SampleIndex != INDEX_NONE ? &GetFocusSamples()[SampleIndex] : nullptr;
+}
+
+TConstArrayView<FTargetFocusSample> UTargetManager::GetFocusSamples()
+{
+	if (FocusUpdateFrame != GFrameCounter)
+	{
+		FocusUpdateFrame = GFrameCounter;
+		UpdateFocusSamples();
+	}
+
+	return FocusSamples;
+}
+
+void UTargetManager::UpdateFocusSamples()
+{
+	LOT_SCOPED_EVENT(TargetManagerUpdateFocusSamples, Blue);
+
+	const double Time = GetWorld()->GetTimeSeconds();
+	const double DeltaTime = Time - FocusUpdateTime;
+	FocusUpdateTime = Time;
+
+	for (auto It = FocusEntries.CreateConstIterator(); It; ++It)
+	{
+		if (!It->Target)
+		{
+			continue;
+		}
+
+		FTargetFocusSample& Sample = FocusSamples[It.GetIndex()];
+		const FVector Location = It->Target->GetFocusLocation(It->Instigator.Get());
+
+		if (!Sample.bValid)
+		{
+			Sample.Velocity = It->Target->GetOwner()->GetVelocity();
+		}
+		else if (DeltaTime > UE_KINDA_SMALL_NUMBER)
+		{
+			Sample.Velocity = (Location - Sample.Location) / DeltaTime;
+		}
+
+		Sample.Location = Location;
+		Sample.bValid = true;
+	}
+}
+
+/*******************************************************************************************/
+/*******************************  Network IDs  *********************************************/
+/*******************************************************************************************/
+
+//0 is reserved for the invalid ID, so the index is offset by 1.
+static uint32 MakeNetTargetId(int32 Index, uint8 Generation)
+{
+	return static_cast<uint32>(Index + 1) | (static_cast<uint32>(Generation) << UTargetManager::NetTargetIndexBits);
+}
+
+static void SplitNetTargetId(uint32 NetTargetId, int32& OutIndex, uint8& OutGeneration)
+{
+	OutIndex = static_cast<int32>(NetTargetId & ((1u << UTargetManager::NetTargetIndexBits) - 1)) - 1;
+	OutGeneration = static_cast<uint8>(NetTargetId >> UTargetManager::NetTargetIndexBits);
+}
+
+void UTargetManager::AssignNetTargetId(UTargetComponent* Target)
+{
+	int32 Index = INDEX_NONE;
+
+	if (!FreeNetTargetSlots.IsEmpty())
+	{
+		Index = FreeNetTargetSlots.Pop(false);
+	}
+	else if (NetTargetSlots.Num() < (1 << NetTargetIndexBits) - 1)
+	{
+		Index = NetTargetSlots.AddDefaulted();
+	}
+	else
+	{
+		//The Target is referenced through its owner instead.
+		LOG_WARNING("Out of compact Target IDs, %s is replicated by the object reference.", *GetNameSafe(Target->GetOwner()));
+		Target->SetNetTargetId(0);
+		return;
+	}
+
+	FNetTargetSlot& Slot = NetTargetSlots[Index];
+	Slot.Target = Target;
+	Target->SetNetTargetId(MakeNetTargetId(Index, Slot.Generation));
+}
+
+void UTargetManager::ReleaseNetTargetId(UTargetComponent* Target)
+{
+	int32 Index;
+	uint8 Generation;
+	SplitNetTargetId(Target->GetNetTargetId(), Index, Generation);
+
+	if (NetTargetSlots.IsValidIndex(Index) && NetTargetSlots[Index].Target == Target)
+	{
+		FNetTargetSlot& Slot = NetTargetSlots[Index];
+		Slot.Target = nullptr;
+
+		//Only the server reuses the slots. Stale IDs of the old Target don't match the new generation.
+		if (Target->GetNetMode() != NM_Client)
+		{
+			++Slot.Generation;
+			FreeNetTargetSlots.Push(static_cast<uint16>(Index));
+		}
+	}
+}
+
+UTargetComponent* UTargetManager::ResolveNetTargetId(uint32 NetTargetId) const
+{
+	int32 Index;
+	uint8 Generation;
+	SplitNetTargetId(NetTargetId, Index, Generation);
+
+	if (NetTargetSlots.IsValidIndex(Index))
+	{
+		const FNetTargetSlot& Slot = NetTargetSlots[Index];
+		return Slot.Generation == Generation ? Slot.Target : nullptr;
+	}
+
+	return nullptr;
+}
+
+void UTargetManager::MapNetTargetId(UTargetComponent* Target)
+{
+	int32 Index;
+	uint8 Generation;
+	SplitNetTargetId(Target->GetNetTargetId(), Index, Generation);
+
+	if (Index == INDEX_NONE || !IsTargetRegistered(Target))
+	{
+		return;
+	}
+
+	if (Index >= NetTargetSlots.Num())
+	{
+		NetTargetSlots.SetNum(Index + 1);
+	}
+
+	//The slot may still hold a Target destroyed on the server but not on the client yet.
+	FNetTargetSlot& Slot = NetTargetSlots[Index];
+	Slot.Target = Target;
+	Slot.Generation = Generation;
+
+	//Resolving notifies the instigator, which may add itself again.
+	for (const TWeakObjectPtr<ULockOnTargetComponent>& WeakInstigator : TArray<TWeakObjectPtr<ULockOnTargetComponent>>(MoveTemp(PendingNetInstigators)))
+	{
+		ULockOnTargetComponent* const Instigator = WeakInstigator.Get();
+
+		if (Instigator && !Instigator->ResolvePendingNetTarget())
+		{
+			AddPendingNetInstigator(Instigator);
+		}
+	}
+}
+
+void UTargetManager::AddPendingNetInstigator(ULockOnTargetComponent* Instigator)
+{
+	PendingNetInstigators.AddUnique(Instigator);
 }
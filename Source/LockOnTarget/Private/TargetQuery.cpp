@@ -0,0 +1,121 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "TargetQuery.h"
+#include "LockOnTargetDefines.h"
+
+#include "Async/ParallelFor.h"
+
+//Smaller sets aren't worth the task overhead.
+static constexpr int32 ParallelQueryThreshold = 512;
+
+static bool PassesQuery(const FTargetQueryEntry& Entry, const FTargetQuery& Query, const FVector& ConeDirection, float ConeCos, FTargetQueryResult& OutResult)
+{
+	if ((Query.bOnlyCapturable && !Entry.bCanBeCaptured) || (Query.bExcludeCaptured && Entry.bIsCaptured))
+	{
+		return false;
+	}
+
+	if ((Query.TeamFilter == ETargetQueryTeamFilter::SameTeam && Entry.TeamId != Query.TeamId)
+		|| (Query.TeamFilter == ETargetQueryTeamFilter::OtherTeams && Entry.TeamId == Query.TeamId))
+	{
+		return false;
+	}
+
+	const FVector Direction = Entry.Location - Query.Location;
+	const double DistanceSq = Direction.SizeSquared();
+
+	if (Query.Radius > 0.f && DistanceSq > FMath::Square(Query.Radius))
+	{
+		return false;
+	}
+
+	const double Distance = FMath::Sqrt(DistanceSq);
+	double Cos = 1.0;
+
+	if (!ConeDirection.IsZero() && Distance > UE_KINDA_SMALL_NUMBER)
+	{
+		Cos = (Direction / Distance) | ConeDirection;
+
+		if (Cos < ConeCos)
+		{
+			return false;
+		}
+	}
+
+	//Tags are the most expensive, so they go last.
+	for (const FName& Tag : Query.RequiredTags)
+	{
+		if (!Entry.Tags.Contains(Tag))
+		{
+			return false;
+		}
+	}
+
+	for (const FName& Tag : Query.ExcludedTags)
+	{
+		if (Entry.Tags.Contains(Tag))
+		{
+			return false;
+		}
+	}
+
+	OutResult.Target = Entry.Target;
+	OutResult.Distance = Distance;
+	OutResult.Angle = ConeDirection.IsZero() ? 0.f : FMath::RadiansToDegrees(FMath::Acos(FMath::Clamp(Cos, -1.0, 1.0)));
+
+	return true;
+}
+
+void TargetQuery::Execute(TConstArrayView<FTargetQueryEntry> Entries, const FTargetQuery& Query, TArray<FTargetQueryResult>& OutResults)
+{
+	LOT_SCOPED_EVENT(TargetQueryExecute, Blue);
+
+	OutResults.Reset();
+
+	const FVector ConeDirection = Query.ConeDirection.GetSafeNormal();
+	const float ConeCos = FMath::Cos(FMath::DegreesToRadians(Query.ConeHalfAngle));
+
+	if (Entries.Num() < ParallelQueryThreshold)
+	{
+		for (const FTargetQueryEntry& Entry : Entries)
+		{
+			FTargetQueryResult Result;
+
+			if (PassesQuery(Entry, Query, ConeDirection, ConeCos, Result))
+			{
+				OutResults.Add(Result);
+			}
+		}
+	}
+	else
+	{
+		//Rejected entries are left with the null Target and compacted afterwards.
+		OutResults.SetNum(Entries.Num());
+
+		ParallelFor(Entries.Num(), [&Entries, &Query, &ConeDirection, ConeCos, &OutResults](int32 Index)
+		{
+			PassesQuery(Entries[Index], Query, ConeDirection, ConeCos, OutResults[Index]);
+		});
+
+		OutResults.RemoveAllSwap([](const FTargetQueryResult& Result) { return Result.Target.IsExplicitlyNull(); }, false);
+	}
+
+	switch (Query.Sort)
+	{
+	case ETargetQuerySort::Distance:
+		OutResults.Sort([](const FTargetQueryResult& Lhs, const FTargetQueryResult& Rhs) { return Lhs.Distance < Rhs.Distance; });
+		break;
+
+	case ETargetQuerySort::Angle:
+		OutResults.Sort([](const FTargetQueryResult& Lhs, const FTargetQueryResult& Rhs) { return Lhs.Angle < Rhs.Angle; });
+		break;
+
+	default:
+		break;
+	}
+
+	if (Query.MaxResults > 0 && OutResults.Num() > Query.MaxResults)
+	{
+		OutResults.SetNum(Query.MaxResults, false);
+	}
+}
@@ -0,0 +1,45 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "LockOnTargetComponent.h"
+#include "TargetComponent.h"
+
+#include "Misc/AutomationTest.h"
+#include "UObject/Package.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLockOnTargetDeferredUnlockPollTest, "LockOnTarget.Component.DeferredUnlockPolls", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FLockOnTargetDeferredUnlockPollTest::RunTest(const FString& Parameters)
+{
+	ULockOnTargetComponent* const LockOn = NewObject<ULockOnTargetComponent>(GetTransientPackage());
+	UTargetComponent* const Target = NewObject<UTargetComponent>(GetTransientPackage());
+	const FName Socket = TEXT("Spine");
+
+	//The Target is locked and applied.
+	LockOn->CurrentTargetInternal = FTargetInfo(Target, Socket);
+	LockOn->bIsTargetLocked = true;
+
+	//An unlock is received during a replay fast-forward, the same as OnTargetInfoUpdated() does.
+	LockOn->AppliedTargetInfo = LockOn->CurrentTargetInternal;
+	LockOn->bTargetUpdateDeferred = true;
+	LockOn->CurrentTargetInternal = FTargetInfo::NULL_TARGET;
+
+	//Polls keep describing the applied Target until the update is flushed.
+	TestTrue(TEXT("The Target is still locked."), LockOn->IsTargetLocked());
+	TestTrue(TEXT("The TargetComponent is the applied one."), LockOn->GetTargetComponent() == Target);
+	TestEqual(TEXT("The Socket is the applied one."), LockOn->GetCapturedSocket(), Socket);
+	TestTrue(TEXT("The TargetActor is the applied one's owner."), LockOn->GetTargetActor() == Target->GetOwner());
+
+	//The deferred unlock is applied.
+	LockOn->bTargetUpdateDeferred = false;
+	LockOn->bIsTargetLocked = false;
+	LockOn->AppliedTargetInfo = FTargetInfo::NULL_TARGET;
+
+	TestFalse(TEXT("The Target is unlocked once applied."), LockOn->IsTargetLocked());
+	TestNull(TEXT("No TargetComponent once applied."), LockOn->GetTargetComponent());
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
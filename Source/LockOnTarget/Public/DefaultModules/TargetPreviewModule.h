@@ -4,6 +4,7 @@
 
 #include "LockOnTargetModuleBase.h"
 #include "LockOnTargetTypes.h"
+#include "TargetHandlers/TargetHandlerBase.h"
 #include "TargetPreviewModule.generated.h"
 
 class UUserWidget;
@@ -32,6 +33,18 @@ public: /** Config */
 	UPROPERTY(EditDefaultsOnly, Category="Target Preview", meta = (ClampMin = 0.f, ClampMax = 1.f, UIMin = 0.f, UIMax = 1.f, Units = "s"))
 	float UpdateRate;
 
+	/** 
+	 * Evaluation used to find the preview Target. The lock itself always uses the full accuracy.
+	 * Only the results of the full accuracy profile (default) can be reused by the lock.
+	 * A cheaper profile may preview a different Target than the lock picks.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Target Preview")
+	FTargetEvaluationProfile EvaluationProfile;
+
+	/** Off-screen and distance culling of the preview widget. */
+	UPROPERTY(EditDefaultsOnly, Category = "Target Preview|Culling")
+	FWidgetCullingSettings Culling;
+
 private: /** Internal */
 
 	//Current preview Target.
@@ -49,6 +62,9 @@ private: /** Internal */
 	//Whether the widget was successfully initialized or not.
 	bool bWidgetIsInitialized;
 
+	//Whether the widget is hidden by the culling.
+	bool bWidgetIsCulled;
+
 	//UpdateRate accumulator.
 	float UpdateTimer;
 
@@ -80,6 +96,9 @@ protected:
 
 	void OnWidgetClassLoaded();
 
+	//Culls the preview widget.
+	void UpdateCulling();
+
 public: /** Overrides */
 
 	//ULockOnTargetModuleBase
@@ -3,10 +3,12 @@
 #pragma once
 
 #include "LockOnTargetModuleBase.h"
+#include "LockOnTargetTypes.h"
 #include "WidgetModule.generated.h"
 
 class UWidgetComponent;
 class UUserWidget;
+class UTargetComponent;
 struct FStreamableHandle;
 
 /**
@@ -27,6 +29,18 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category = "Widget")
 	TSoftClassPtr<UUserWidget> DefaultWidgetClass;
 
+	/** Custom widget classes of Targets within this radius around the owner are loaded in advance. 0 disables the prefetch. */
+	UPROPERTY(EditDefaultsOnly, Category = "Widget|Prefetch", meta = (ClampMin = 0.f, UIMin = 0.f, Units = "cm"))
+	float PrefetchRadius;
+
+	/** How often Targets are checked for the prefetch. */
+	UPROPERTY(EditDefaultsOnly, Category = "Widget|Prefetch", meta = (ClampMin = 0.f, UIMin = 0.f, Units = "s", EditCondition = "PrefetchRadius > 0", EditConditionHides))
+	float PrefetchInterval;
+
+	/** Off-screen and distance culling of the widget. */
+	UPROPERTY(EditDefaultsOnly, Category = "Widget|Culling")
+	FWidgetCullingSettings Culling;
+
 private:
 
 	//The actual widget to display.
@@ -42,6 +56,23 @@ private:
 	//Whether the widget was successfully initialized or not.
 	bool bWidgetIsInitialized;
 
+	//Whether the widget is hidden by the culling.
+	bool bWidgetIsCulled;
+
+	//Whether the widget is hidden by SetWidgetVisibility().
+	bool bWidgetIsHiddenManually;
+
+	//Prefetched widget class, shared by all Targets within PrefetchRadius which use it.
+	struct FWidgetClassPrefetch
+	{
+		TSharedPtr<FStreamableHandle> Handle;
+		int32 RefCount = 0;
+	};
+
+	TMap<FSoftObjectPath, FWidgetClassPrefetch> PrefetchedClasses;
+	TMap<TWeakObjectPtr<UTargetComponent>, FSoftObjectPath> PrefetchingTargets;
+	float PrefetchTimer;
+
 public:
 
 	bool IsWidgetInitialized() const;
@@ -66,6 +97,15 @@ protected:
 
 	void OnWidgetClassLoaded();
 
+	//Culls the active widget.
+	void UpdateCulling();
+
+	//Prefetch
+	void UpdatePrefetch();
+	void AddPrefetchReference(const FSoftObjectPath& WidgetClass);
+	void ReleasePrefetchReference(const FSoftObjectPath& WidgetClass);
+	void ReleaseAllPrefetches();
+
 protected: /** Overrides */
 
 	//ULockOnTargetModuleBase
@@ -74,4 +114,5 @@ protected: /** Overrides */
 	virtual void OnTargetLocked(UTargetComponent* Target, FName Socket) override;
 	virtual void OnTargetUnlocked(UTargetComponent* UnlockedTarget, FName Socket) override;
 	virtual void OnSocketChanged(UTargetComponent* CurrentTarget, FName NewSocket, FName OldSocket) override;
+	virtual void Update(float DeltaTime) override;
 };
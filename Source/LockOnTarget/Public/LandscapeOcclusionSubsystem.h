@@ -0,0 +1,88 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LandscapeOcclusionSubsystem.generated.h"
+
+class ALandscapeProxy;
+class ULevel;
+class UWorld;
+
+/**
+ * Cheap terrain occlusion test based on a lazily sampled, downsampled copy of the landscape heightfield.
+ * Each cell stores the lowest landscape vertex around it, which bounds the terrain inside the cell from below.
+ * So a ray is reported as occluded only if it passes entirely below the terrain of some cell. Landscape holes (e.g. caves) aren't taken into account.
+ */
+UCLASS(Config = Game)
+class LOCKONTARGET_API ULandscapeOcclusionSubsystem final : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	ULandscapeOcclusionSubsystem();
+	static ULandscapeOcclusionSubsystem* Get(const UWorld* InWorld);
+
+public: /** Config */
+
+	/** Size of the heightfield cell. Bigger cells are cheaper to march but less precise. */
+	UPROPERTY(Config)
+	float CellSize;
+
+	/** Max number of cells to march per ray. Longer rays are reported as not occluded. */
+	UPROPERTY(Config)
+	int32 MaxCellsPerRay;
+
+	/** Max number of sampled cells to keep. The cache is reset once this number is exceeded. */
+	UPROPERTY(Config)
+	int32 MaxCachedSamples;
+
+private: /** Internal */
+
+	struct FLandscapeEntry
+	{
+		TWeakObjectPtr<ALandscapeProxy> Proxy;
+		FBox2D Bounds;
+	};
+
+	//Landscapes in the world with their 2D bounds.
+	TArray<FLandscapeEntry> Landscapes;
+
+	//The lowest terrain height in the cell. TNumericLimits<float>::Lowest() if the cell isn't fully covered by landscapes.
+	TMap<FIntPoint, float> CellMinHeights;
+
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+
+	bool bLandscapesGathered;
+
+public:
+
+	/**
+	 * Marches the ray over the heightfield cells (DDA) and checks whether it passes below the terrain.
+	 *
+	 * @param Tolerance - How deep (in uu) the ray must be under the terrain to be treated as occluded.
+	 * @return - true if the ray is definitely blocked by the terrain.
+	 */
+	bool IsRayOccluded(const FVector& From, const FVector& To, float Tolerance);
+
+	/** Clears all sampled heights and gathered landscapes. */
+	void Invalidate();
+
+private:
+
+	void GatherLandscapes();
+	float GetCellMinHeight(int32 CellX, int32 CellY);
+	float SampleCellMinHeight(const FBox2D& CellBounds) const;
+	void InvalidateCells(const FBox2D& Bounds);
+	void OnLevelChanged(ULevel* InLevel, UWorld* InWorld);
+
+protected: /** Overrides */
+
+	//UWorldSubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type Type) const override;
+};
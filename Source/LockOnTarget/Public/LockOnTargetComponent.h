@@ -5,6 +5,8 @@
 #include "Components/ActorComponent.h"
 #include "CoreMinimal.h"
 #include "LockOnTargetTypes.h"
+#include "HAL/CriticalSection.h"
+#include <atomic>
 #include "LockOnTargetComponent.generated.h"
 
 class ULockOnTargetComponent;
@@ -36,6 +38,8 @@ public:
 
 	ULockOnTargetComponent();
 	friend class FGDC_LockOnTarget; //Gameplay Debugger
+	friend class ULockOnTargetGovernor; //Significance LOD.
+	friend class FLockOnTargetDeferredUnlockPollTest; //Automation test.
 	
 private: /** Core Config */
 
@@ -47,6 +51,21 @@ private: /** Core Config */
 	UPROPERTY(Instanced, EditDefaultsOnly, Category = "Default Settings", meta = (NoResetToDefault))
 	TObjectPtr<UTargetHandlerBase> TargetHandlerImplementation;
 	
+	/** 
+	 * Ticks with all other aggregated LockOnTargetComponents in a single tick function of ULockOnTargetTickManager.
+	 * Reduces the tick overhead for many instances, but the component's own tick function is disabled.
+	 * Ignored by Blueprint classes which implement the Event Tick.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Default Settings", AdvancedDisplay)
+	bool bUseAggregatedTick;
+
+	/**
+	 * Publishes the snapshot for GetSnapshot() from the start. Otherwise publishing starts with the first GetSnapshot() call,
+	 * which returns the empty snapshot until the next update. Nothing is published for the components without consumers.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Default Settings", AdvancedDisplay)
+	bool bPublishSnapshot;
+
 	/** Set of customizable dynamic features. The order isn't defined. Add/RemoveModuleByClass(). */
 	UPROPERTY(Instanced, EditDefaultsOnly, Category = "Modules", meta = (DisplayName = "Default Modules", NoResetToDefault))
 	TArray<TObjectPtr<ULockOnTargetModuleBase>> Modules;
@@ -76,6 +95,17 @@ public: /** Input Config */
 	/** Unfreeze the InputBuffer filling if the input is less than the threshold. */
 	UPROPERTY(EditDefaultsOnly, Category = "Player Input", meta = (ClampMin = 0.f, UIMin = 0.f, EditCondition = "bFreezeInputAfterSwitch", EditConditionHides))
 	float UnfreezeThreshold;
+
+	/**
+	 * Integrate the input and trigger the switch as the input events arrive instead of on the next component tick.
+	 * Each axis is integrated over the time since its previous event, so the threshold doesn't depend on the frame rate.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Player Input")
+	bool bProcessInputOnEvent;
+
+	/** The longest time an input event is integrated over. Also the time after which the axis is considered released. */
+	UPROPERTY(EditDefaultsOnly, Category = "Player Input", meta = (ClampMin = 0.001f, UIMin = 0.001f, Units = "s", EditCondition = "bProcessInputOnEvent", EditConditionHides))
+	float MaxInputEventInterval;
 	
 public: /** Callbacks */
 
@@ -112,6 +142,36 @@ private: /** Internal */
 	//Is any Target captured.
 	bool bIsTargetLocked;
 
+	//Replicated Target updates received during a replay fast-forward are applied at once when the playback resumes.
+	bool bTargetUpdateDeferred;
+
+	//Whether the component is ticked by ULockOnTargetTickManager instead of its own tick function.
+	bool bIsTickAggregated;
+
+	//The Target the component and modules were notified about last. Only valid while the update is deferred.
+	FTargetInfo AppliedTargetInfo;
+
+	//The Target described by bIsTargetLocked. The replicated one may be newer while the update is deferred.
+	const FTargetInfo& GetAppliedTarget() const { return bTargetUpdateDeferred ? AppliedTargetInfo : CurrentTargetInternal; }
+
+	//Lock on state for the other threads. Written on the game thread under the lock.
+	UPROPERTY(Transient)
+	FLockOnTargetSnapshot Snapshot;
+
+	mutable FRWLock SnapshotLock;
+
+	//Whether anyone reads the snapshot. Set by GetSnapshot() on any thread.
+	mutable std::atomic<bool> bSnapshotRequested;
+
+	//Significance LOD level assigned by ULockOnTargetGovernor. INDEX_NONE if not throttled, e.g. player controlled.
+	int32 SignificanceLevel;
+
+	//The last search time limited by the significance LOD.
+	double LastSearchTime;
+
+	//Time accumulated since the last modules update.
+	float ModulesUpdateTime;
+
 protected: /** Input Internal */
 
 	bool bInputFrozen;
@@ -120,6 +180,10 @@ protected: /** Input Internal */
 	FVector2D InputBuffer;
 	FVector2D InputVector;
 
+	//World time of the last input event per axis. Only used if bProcessInputOnEvent.
+	double YawInputTime;
+	double PitchInputTime;
+
 public: /** Polls */
 
 	/** Is any Target locked. */
@@ -128,11 +192,11 @@ public: /** Polls */
 
 	/** Gets the currently locked TargetComponent, if exists, otherwise nullptr. */
 	UFUNCTION(BlueprintPure, Category = "LockOnTargetComponent|Polls")
-	UTargetComponent* GetTargetComponent() const { return IsTargetLocked() ? CurrentTargetInternal.TargetComponent : nullptr; }
+	UTargetComponent* GetTargetComponent() const { return IsTargetLocked() ? GetAppliedTarget().TargetComponent : nullptr; }
 
 	/** Gets the captured socket, if exists, otherwise NAME_None. */
 	UFUNCTION(BlueprintPure, Category = "LockOnTargetComponent|Polls")
-	FName GetCapturedSocket() const { return IsTargetLocked() ? CurrentTargetInternal.Socket : NAME_None; }
+	FName GetCapturedSocket() const { return IsTargetLocked() ? GetAppliedTarget().Socket : NAME_None; }
 
 	/** Gets the currently locked AActor, if exists, otherwise nullptr. */
 	UFUNCTION(BlueprintPure, Category = "LockOnTargetComponent|Polls")
@@ -150,6 +214,17 @@ public: /** Polls */
 	UFUNCTION(BlueprintPure, Category = "LockOnTargetComponent|Polls")
 	FVector GetCapturedFocusLocation() const;
 
+	/**
+	 * Returns the lock on state published after the last update. Safe to call from any thread, e.g. BlueprintThreadSafeUpdateAnimation.
+	 * The snapshot is only published once requested, see bPublishSnapshot.
+	 */
+	UFUNCTION(BlueprintPure, Category = "LockOnTargetComponent|Polls", meta = (BlueprintThreadSafe))
+	FLockOnTargetSnapshot GetSnapshot() const;
+
+	/** Significance LOD level assigned by ULockOnTargetGovernor. 0 is the highest throttled fidelity, -1 means not throttled, e.g. player controlled. */
+	UFUNCTION(BlueprintPure, Category = "LockOnTargetComponent|Polls")
+	int32 GetSignificanceLevel() const { return SignificanceLevel; }
+
 	/** Are we ready/able to capture Targets. Also checks for ownership and completeness of initialization. */
 	UFUNCTION(BlueprintPure, Category = "LockOnTargetComponent|Can Capture Target")
 	bool CanCaptureTarget() const;
@@ -203,6 +278,14 @@ protected: /** Target Handling */
 	//Only the locally controlled Owner can control the Target.
 	bool HasAuthorityOverTarget() const;
 
+public:
+
+	//Records the search if the significance LOD allows one more at the moment.
+	bool ConsumeSearchAllowance();
+
+	//Applies the Target received by the compact ID once it's mapped. Returns false if it's still pending.
+	bool ResolvePendingNetTarget();
+
 public: /** Target Validation */
 
 	//Can the Target be captured.
@@ -226,6 +309,15 @@ private: /** Target State Workhorse */
 
 	UFUNCTION()
 	void OnTargetInfoUpdated(const FTargetInfo& OldTarget);
+
+	//Dispatches the Target change to the system callbacks.
+	void ApplyTargetInfoUpdate(const FTargetInfo& OldTarget);
+
+	//Applies the final Target state coalesced during a replay fast-forward.
+	void FlushDeferredTargetUpdate();
+
+	//Whether the replay is being fast-forwarded or scrubbed, i.e. states are skipped within the frame.
+	bool IsReplayFastForwarding() const;
 	
 protected: /** System Callbacks */
 
@@ -247,13 +339,29 @@ public: /** Overrides */
 
 	//UActorComponent
 	virtual void InitializeComponent() override;
+	virtual void BeginPlay() override;
 	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void SetComponentTickEnabled(bool bEnabled) override;
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
+public: /** Tick Phases */
+
+	/** Updates the targeting duration, processes the input and checks the Target state. */
+	void TickTargeting(float DeltaTime);
+
+	/** Updates all modules and the TargetHandler. */
+	void TickModules(float DeltaTime);
+
+	/** Publishes the current state for GetSnapshot() if it's been requested. */
+	void PublishSnapshot();
+
 protected: /** Input */
 
 	virtual void ProcessAnalogInput(float DeltaInput);
+	void ProcessInputEvent(float Axis, double& AxisInputTime, double OtherAxisInputTime, bool bYaw);
+	void ReleaseIdleInput();
+	void AccumulateInput(FVector2D Input, FVector2D DeltaBuffer);
 	FVector2D ConsumeInput();
 	bool IsInputDelayActive() const;
 	void ActivateInputDelay();
@@ -0,0 +1,225 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LockOnTargetGovernor.generated.h"
+
+class UWorld;
+class ULockOnTargetComponent;
+class USignificanceManager;
+
+/** Lock on quality levels, from the best to the cheapest. */
+UENUM(BlueprintType)
+enum class ELockOnTargetQuality : uint8
+{
+	High,
+	Medium,
+	Low,
+	Minimal,
+
+	MAX UMETA(Hidden)
+};
+
+/**
+ * Degradations applied at a certain quality level.
+ */
+USTRUCT(BlueprintType)
+struct LOCKONTARGET_API FLockOnTargetQualitySettings
+{
+	GENERATED_BODY()
+
+public:
+
+	/** TargetPreviewModule::UpdateRate multiplier. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Quality Settings", meta = (ClampMin = 1.f, UIMin = 1.f))
+	float PreviewUpdateRateScale = 1.f;
+
+	/** Only the first Socket of each Target is processed while finding a Target. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Quality Settings")
+	bool bRepresentativeSocketOnly = false;
+
+	/** Max number of candidates which pass the Line of Sight check per search. 0 = unlimited. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Quality Settings", meta = (ClampMin = 0, UIMin = 0))
+	int32 MaxLineOfSightChecks = 0;
+
+	/** UThirdPersonTargetHandler::CheckInterval multiplier. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Quality Settings", meta = (ClampMin = 1.f, UIMin = 1.f))
+	float CheckIntervalScale = 1.f;
+};
+
+/**
+ * Fidelity of an AI instigator at a certain significance level.
+ */
+USTRUCT(BlueprintType)
+struct LOCKONTARGET_API FLockOnTargetSignificanceSettings
+{
+	GENERATED_BODY()
+
+public:
+
+	/** The level is assigned to instigators within this distance to the nearest view. 0 = any distance. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Significance Settings", meta = (ClampMin = 0.f, UIMin = 0.f, Units = "cm"))
+	float MaxDistance = 0.f;
+
+	/** UThirdPersonTargetHandler::CheckInterval multiplier. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Significance Settings", meta = (ClampMin = 1.f, UIMin = 1.f))
+	float CheckIntervalScale = 1.f;
+
+	/** Max number of searches per second, including the automatic ones. 0 = unlimited. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Significance Settings", meta = (ClampMin = 0.f, UIMin = 0.f))
+	float MaxSearchesPerSecond = 0.f;
+
+	/** Whether the Line of Sight is checked. Otherwise only the distance is trusted. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Significance Settings")
+	bool bLineOfSight = true;
+
+	/** Modules and the TargetHandler are updated at this interval. 0 = every tick. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Significance Settings", meta = (ClampMin = 0.f, UIMin = 0.f, Units = "s"))
+	float ModuleTickInterval = 0.f;
+};
+
+/**
+ * Measures the lock on CPU time per frame and adapts the quality level to the budget.
+ * The quality is degraded step by step while the budget is exceeded and restored when there's enough headroom.
+ * Each transition is logged and marked in the trace and CSV profiles.
+ *
+ * Also assigns a significance LOD level to each AI instigator by its distance to the nearest player view.
+ * Player controlled instigators always keep the full fidelity.
+ */
+UCLASS(Config = Game)
+class LOCKONTARGET_API ULockOnTargetGovernor final : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	ULockOnTargetGovernor();
+	static ULockOnTargetGovernor* Get(const UWorld* InWorld);
+
+	/** Current quality settings of the World, or the default ones if there's no governor. */
+	static const FLockOnTargetQualitySettings& GetQualitySettings(const UWorld* InWorld);
+
+	/** Significance settings of the instigator, or the default unthrottled ones if the significance LOD isn't used or the instigator is player controlled. */
+	static const FLockOnTargetSignificanceSettings& GetSignificanceSettings(const ULockOnTargetComponent* Instigator);
+
+	/** Measures the lock on work within the scope. Nested scopes are measured once. */
+	struct LOCKONTARGET_API FCostScope
+	{
+		explicit FCostScope(ULockOnTargetGovernor* InGovernor);
+		~FCostScope();
+
+	private:
+
+		ULockOnTargetGovernor* Governor;
+		double StartTime;
+	};
+
+public: /** Config */
+
+	/** Whether the governor adapts the quality. */
+	UPROPERTY(Config)
+	bool bEnabled;
+
+	/** Lock on CPU time budget per frame. */
+	UPROPERTY(Config)
+	float BudgetMs;
+
+	/** The quality is restored once the average cost falls below BudgetMs * RestoreBudgetRatio. */
+	UPROPERTY(Config)
+	float RestoreBudgetRatio;
+
+	/** Number of frames over the budget to degrade the quality by one level. */
+	UPROPERTY(Config)
+	int32 FramesToDegrade;
+
+	/** Number of frames with headroom to restore the quality by one level. */
+	UPROPERTY(Config)
+	int32 FramesToRestore;
+
+	/** Settings for each ELockOnTargetQuality level. */
+	UPROPERTY(Config)
+	TArray<FLockOnTargetQualitySettings> QualityLevels;
+
+public: /** Significance Config */
+
+	/** Whether AI instigators get the significance LOD. */
+	UPROPERTY(Config)
+	bool bSignificanceLOD;
+
+	/**
+	 * Whether AI instigators are registered in the USignificanceManager, which recomputes the significance on its own cadence.
+	 * The game has to update the manager with its view points. Otherwise the governor recomputes the significance itself.
+	 * Requires LOT_SIGNIFICANCE_MANAGER, see LockOnTarget.Build.cs.
+	 */
+	UPROPERTY(Config)
+	bool bUseSignificanceManager;
+
+	/** How often the governor recomputes the significance. Not used with the USignificanceManager. */
+	UPROPERTY(Config)
+	float SignificanceUpdateInterval;
+
+	/** Instigators outside the view cone are treated as being farther by this multiplier. */
+	UPROPERTY(Config)
+	float OffScreenDistanceScale;
+
+	/** Half angle of the view cone, which approximates the screen. */
+	UPROPERTY(Config)
+	float ViewConeHalfAngle;
+
+	/** Settings for each significance level, from the closest to the farthest. */
+	UPROPERTY(Config)
+	TArray<FLockOnTargetSignificanceSettings> SignificanceLevels;
+
+private: /** Internal */
+
+	ELockOnTargetQuality Quality;
+	double FrameCostSeconds;
+	float AverageCostMs;
+	int32 OverBudgetFrames;
+	int32 UnderBudgetFrames;
+	int32 ScopeDepth;
+
+	//Instigators which receive the significance LOD.
+	TArray<TWeakObjectPtr<ULockOnTargetComponent>> Instigators;
+	float SignificanceUpdateTimer;
+
+public:
+
+	/** Current quality level. */
+	UFUNCTION(BlueprintPure, Category = "LockOnTarget Governor")
+	ELockOnTargetQuality GetQuality() const { return Quality; }
+
+	/** Smoothed lock on CPU time per frame. */
+	UFUNCTION(BlueprintPure, Category = "LockOnTarget Governor")
+	float GetAverageCostMs() const { return AverageCostMs; }
+
+	/** Forces the quality level. The governor keeps adapting it if enabled. */
+	UFUNCTION(BlueprintCallable, Category = "LockOnTarget Governor")
+	void SetQuality(ELockOnTargetQuality NewQuality);
+
+	const FLockOnTargetQualitySettings& GetCurrentQualitySettings() const;
+
+	/** Starts assigning the significance LOD to the instigator. */
+	void RegisterInstigator(ULockOnTargetComponent* Instigator);
+
+	/** Stops assigning the significance LOD to the instigator. */
+	void UnregisterInstigator(ULockOnTargetComponent* Instigator);
+
+private: /** Significance */
+
+	USignificanceManager* GetSignificanceManager() const;
+	void UpdateSignificance();
+	float CalculateSignificance(const ULockOnTargetComponent* Instigator, const FTransform& ViewPoint) const;
+	int32 GetSignificanceLevel(const ULockOnTargetComponent* Instigator, float Significance) const;
+
+protected: /** Overrides */
+
+	//UTickableWorldSubsystem
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	//UWorldSubsystem
+	virtual bool DoesSupportWorldType(const EWorldType::Type Type) const override;
+};
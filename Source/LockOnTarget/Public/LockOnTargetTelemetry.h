@@ -0,0 +1,115 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LockOnTargetTelemetry.generated.h"
+
+class UWorld;
+
+/** Kinds of measured lock on calls. */
+enum class ELockOnTargetTelemetryCall : uint8
+{
+	FindTarget,
+	CheckTargetState
+};
+
+/**
+ * Lock on cost aggregated within a single grid cell.
+ */
+struct FLockOnTargetTelemetryCell
+{
+	int32 Searches = 0;
+	double SearchTotalMs = 0.0;
+	float SearchMaxMs = 0.f;
+
+	int32 Checks = 0;
+	double CheckTotalMs = 0.0;
+	float CheckMaxMs = 0.f;
+
+	int64 Candidates = 0;
+	int64 Traces = 0;
+
+	//Used to place the cell vertically in the heatmap.
+	double SumZ = 0.0;
+};
+
+/**
+ * Opt-in playtest telemetry. Buckets the lock on cost, candidate and trace counts by the instigator location on a coarse 2D grid.
+ * Aggregates are periodically written to Saved/LockOnTarget/Telemetry/<Map>_<Time>.csv.
+ * The file can be overlaid on the level in the editor with lot.ShowTelemetryHeatmap.
+ */
+UCLASS(Config = Game)
+class LOCKONTARGET_API ULockOnTargetTelemetry final : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	ULockOnTargetTelemetry();
+	static ULockOnTargetTelemetry* Get(const UWorld* InWorld);
+
+	/**
+	 * Measures the call within the scope. The counters are read at the end of the scope.
+	 * The time of nested scopes (e.g. a search caused by a check) is recorded by them and excluded from the outer one.
+	 */
+	struct LOCKONTARGET_API FRecordScope
+	{
+		FRecordScope(ULockOnTargetTelemetry* InTelemetry, ELockOnTargetTelemetryCall InCall, const FVector& InLocation, const int32& InCandidates, const int32& InTraces);
+		~FRecordScope();
+
+	private:
+
+		ULockOnTargetTelemetry* Telemetry;
+		FRecordScope* OuterScope;
+		ELockOnTargetTelemetryCall Call;
+		FVector Location;
+		const int32& Candidates;
+		const int32& Traces;
+		double StartTime;
+		double NestedTime;
+	};
+
+public: /** Config */
+
+	/** Whether the telemetry is collected. */
+	UPROPERTY(Config)
+	bool bEnabled;
+
+	/** Grid cell size in the XY plane. */
+	UPROPERTY(Config)
+	float CellSize;
+
+	/** Interval of writing the aggregates to disk. */
+	UPROPERTY(Config)
+	float FlushInterval;
+
+private: /** Internal */
+
+	TMap<FIntPoint, FLockOnTargetTelemetryCell> Cells;
+	FString FilePath;
+	float FlushTimer;
+	bool bDirty;
+
+	//The innermost recording scope.
+	FRecordScope* ActiveScope;
+
+protected:
+
+	void Record(ELockOnTargetTelemetryCall Call, const FVector& Location, double DurationMs, int32 Candidates, int32 Traces);
+
+	/** Writes all aggregates since the World start. */
+	void Flush();
+
+protected: /** Overrides */
+
+	//UTickableWorldSubsystem
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	//UWorldSubsystem
+	virtual bool DoesSupportWorldType(const EWorldType::Type Type) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+};
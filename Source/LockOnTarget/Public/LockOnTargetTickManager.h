@@ -0,0 +1,84 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LockOnTargetTickManager.generated.h"
+
+class ULockOnTargetComponent;
+class ULockOnTargetTickManager;
+class UWorld;
+
+/**
+ * Single tick function which ticks all registered LockOnTargetComponents.
+ */
+USTRUCT()
+struct FLockOnTargetTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+public:
+
+	ULockOnTargetTickManager* Manager = nullptr;
+
+	//FTickFunction
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+	virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FLockOnTargetTickFunction> : public TStructOpsTypeTraitsBase2<FLockOnTargetTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Ticks LockOnTargetComponents with ULockOnTargetComponent::bUseAggregatedTick in one tick function (TG_PostPhysics).
+ * Each phase (targeting, modules) runs over all components in a tight loop, avoiding the per-component tick task overhead.
+ * DeltaTime is dilated by the owner's CustomTimeDilation, the same as with the component's own tick function.
+ * 
+ * @Note: Components lose the per-owner tick prerequisites.
+ */
+UCLASS()
+class LOCKONTARGET_API ULockOnTargetTickManager final : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	ULockOnTargetTickManager();
+	static ULockOnTargetTickManager* Get(const UWorld* InWorld);
+	friend FLockOnTargetTickFunction;
+
+private: /** Internal */
+
+	FLockOnTargetTickFunction TickFunction;
+
+	//Registered components. Unregistered ones are nulled while ticking and compacted afterwards.
+	TArray<ULockOnTargetComponent*> Components;
+
+	bool bIsTicking;
+	bool bHasPendingRemovals;
+
+public:
+
+	void RegisterComponent(ULockOnTargetComponent* Component);
+	void UnregisterComponent(ULockOnTargetComponent* Component);
+	int32 GetComponentsNum() const { return Components.Num(); }
+
+private:
+
+	void Tick(float DeltaTime);
+
+protected: /** Overrides */
+
+	//UWorldSubsystem
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type Type) const override;
+};
@@ -0,0 +1,50 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Config.h"
+#include "Trace/Trace.h"
+
+#define LOT_TRACE_ENABLED (UE_TRACE_ENABLED && !UE_BUILD_SHIPPING)
+
+/** Target events of the lock on timeline. */
+enum class ELockOnTargetTraceEvent : uint8
+{
+	Locked,
+	Unlocked,
+	SocketChanged
+};
+
+#if LOT_TRACE_ENABLED
+
+class ULockOnTargetComponent;
+class UTargetComponent;
+
+UE_TRACE_CHANNEL_EXTERN(LockOnTargetChannel, LOCKONTARGET_API);
+
+/**
+ * Outputs lock on events to the trace, decoded by the LockOnTargetEditor Insights extension into a per-instigator timeline.
+ * Enable with -trace=default,lockontarget or Trace.Enable LockOnTarget.
+ */
+struct LOCKONTARGET_API FLockOnTargetTrace
+{
+	static void OutputTargetEvent(const ULockOnTargetComponent* Instigator, ELockOnTargetTraceEvent Event, const UTargetComponent* Target, FName Socket);
+	static void OutputSearch(const ULockOnTargetComponent* Instigator, uint64 StartCycle, int32 NumCandidates, int32 NumTraces, bool bFound);
+	static void OutputLineOfSightTraces(const ULockOnTargetComponent* Instigator, int32 NumTraces);
+	static void OutputLineOfSightTimer(const ULockOnTargetComponent* Instigator, bool bActive);
+};
+
+#define LOT_TRACE_TARGET_EVENT(Instigator, Event, Target, Socket) FLockOnTargetTrace::OutputTargetEvent(Instigator, ELockOnTargetTraceEvent::Event, Target, Socket)
+#define LOT_TRACE_SEARCH(Instigator, StartCycle, NumCandidates, NumTraces, bFound) FLockOnTargetTrace::OutputSearch(Instigator, StartCycle, NumCandidates, NumTraces, bFound)
+#define LOT_TRACE_LINE_OF_SIGHT_TRACES(Instigator, NumTraces) FLockOnTargetTrace::OutputLineOfSightTraces(Instigator, NumTraces)
+#define LOT_TRACE_LINE_OF_SIGHT_TIMER(Instigator, bActive) FLockOnTargetTrace::OutputLineOfSightTimer(Instigator, bActive)
+
+#else
+
+#define LOT_TRACE_TARGET_EVENT(Instigator, Event, Target, Socket)
+#define LOT_TRACE_SEARCH(Instigator, StartCycle, NumCandidates, NumTraces, bFound)
+#define LOT_TRACE_LINE_OF_SIGHT_TRACES(Instigator, NumTraces)
+#define LOT_TRACE_LINE_OF_SIGHT_TIMER(Instigator, bActive)
+
+#endif //LOT_TRACE_ENABLED
@@ -6,6 +6,10 @@
 #include "LockOnTargetTypes.generated.h"
 
 class UTargetComponent;
+class UTargetManager;
+class APlayerController;
+class UWidgetComponent;
+class AActor;
 
 /**
  * Holds information related to the Target.
@@ -31,6 +35,12 @@ public:
 
 	uint32 GetSocketIndex() const;
 
+	/** Resolves the Target received by the compact ID. Returns false if the ID isn't mapped yet. */
+	bool ResolveNetTarget(const UTargetManager& TargetManager);
+
+	/** Whether the Target has been received by the compact ID, but not resolved yet. */
+	bool IsNetTargetPending() const { return NetTargetId != 0; }
+
 public:
 
 	UPROPERTY(BlueprintReadWrite, Category = "TargetInfo")
@@ -38,6 +48,10 @@ public:
 	
 	UPROPERTY(BlueprintReadWrite, Category = "TargetInfo")
 	FName Socket = NAME_None;
+
+	//Received compact ID and Socket index. Only set until ResolveNetTarget() succeeds.
+	uint32 NetTargetId = 0;
+	uint32 NetSocketIndex = 0;
 };
 
 template<>
@@ -60,6 +74,78 @@ inline bool operator!=(const FTargetInfo& lhs, const FTargetInfo& rhs)
 	return !(lhs == rhs);
 }
 
+/**
+ * Lock on state of ULockOnTargetComponent published once per frame. Safe to read on any thread, e.g. in the animation update.
+ */
+USTRUCT(BlueprintType)
+struct LOCKONTARGET_API FLockOnTargetSnapshot
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadOnly, Category = "LockOnTarget Snapshot")
+	bool bIsTargetLocked = false;
+
+	/** Only for comparisons and passing around off the game thread. */
+	UPROPERTY(BlueprintReadOnly, Category = "LockOnTarget Snapshot")
+	TObjectPtr<AActor> TargetActor = nullptr;
+
+	UPROPERTY(BlueprintReadOnly, Category = "LockOnTarget Snapshot")
+	FName Socket = NAME_None;
+
+	UPROPERTY(BlueprintReadOnly, Category = "LockOnTarget Snapshot")
+	FVector FocusLocation = FVector::ZeroVector;
+
+	/** Normalized direction from the owner to the FocusLocation. */
+	UPROPERTY(BlueprintReadOnly, Category = "LockOnTarget Snapshot")
+	FVector DirectionToTarget = FVector::ZeroVector;
+
+	/** Distance from the owner to the FocusLocation. */
+	UPROPERTY(BlueprintReadOnly, Category = "LockOnTarget Snapshot")
+	float DistanceToTarget = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "LockOnTarget Snapshot")
+	float TargetingDuration = 0.f;
+};
+
+/**
+ * Culling of a lock on widget attached to a Target.
+ * Screen space widgets are ticked and painted by Slate every frame while visible, so hiding them is the only way to save their cost.
+ */
+USTRUCT(BlueprintType)
+struct LOCKONTARGET_API FWidgetCullingSettings
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Hides the widget while its location is off-screen or behind the camera. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Widget Culling")
+	bool bCullOffScreen = true;
+
+	/** Screen fraction outside the viewport within which the widget is still considered on-screen. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Widget Culling", meta = (ClampMin = 0.f, UIMin = 0.f, UIMax = 0.5f, EditCondition = "bCullOffScreen"))
+	float OffScreenMargin = 0.05f;
+
+	/** Hides the widget beyond this distance from the camera. 0 disables the distance culling. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Widget Culling", meta = (ClampMin = 0.f, UIMin = 0.f, Units = "cm"))
+	float CullDistance = 0.f;
+
+public:
+
+	/** Returns false if the widget at the location should be culled. */
+	bool Evaluate(const APlayerController* PlayerController, const FVector& Location) const;
+
+	/**
+	 * Evaluates the culling of the widget component and updates its visibility if the culled state has changed.
+	 *
+	 * @param bInOutIsCulled - The culled state of the widget, which is kept by the caller.
+	 * @param bIsHiddenManually - Whether the widget stays hidden regardless of the culling.
+	 */
+	void UpdateWidget(UWidgetComponent* Widget, const APlayerController* PlayerController, bool& bInOutIsCulled, bool bIsHiddenManually = false) const;
+};
+
 /**
  * The types of exceptions/interrupts that Targets can dispatch to Invaders. Supports event-driven design.
  */
@@ -0,0 +1,106 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LockOnTargetWatchdog.generated.h"
+
+class UWorld;
+class ULockOnTargetWatchdog;
+
+/**
+ * Detailed record of a single watched call. Only filled while the watchdog is enabled.
+ */
+struct LOCKONTARGET_API FLockOnTargetWatchdogCapture
+{
+	struct FCandidate
+	{
+		FString Target;
+		FName Socket = NAME_None;
+		FVector Location = FVector::ZeroVector;
+		float Modifier = 0.f;
+	};
+
+	/** Records the time spent since the previous stage. */
+	void MarkStage(const TCHAR* StageName);
+
+	const TCHAR* ScopeName = nullptr;
+	uint64 FrameNumber = 0;
+	FVector ViewLocation = FVector::ZeroVector;
+
+	TArray<TPair<const TCHAR*, double>, TInlineAllocator<8>> StageTimingsMs;
+	TArray<FCandidate> Candidates;
+
+	//Calls of BlueprintNativeEvent hooks, whether they're overridden in script or not.
+	int32 BlueprintHookCalls = 0;
+
+	//Line of Sight rays that reached the physics scene.
+	int32 TracesIssued = 0;
+
+private:
+
+	friend ULockOnTargetWatchdog;
+	const UObject* InstigatorObject = nullptr;
+	double StartTime = 0.0;
+	double LastStageTime = 0.0;
+};
+
+/**
+ * Watches the duration of expensive lock on calls (finding a Target, checking the Target state).
+ * If a call exceeds the threshold, its capture is written to Saved/LockOnTarget/Watchdog and a trace bookmark is emitted,
+ * so rare spikes can be analyzed after the fact.
+ *
+ * While enabled, every watched call fills a capture, which isn't free. Intended for playtests and development builds.
+ */
+UCLASS(Config = Game)
+class LOCKONTARGET_API ULockOnTargetWatchdog final : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	ULockOnTargetWatchdog();
+	static ULockOnTargetWatchdog* Get(const UWorld* InWorld);
+
+	/** Watches the call within the scope. The capture is only valid if the watchdog is enabled. */
+	struct LOCKONTARGET_API FWatchScope
+	{
+		FWatchScope(ULockOnTargetWatchdog* InWatchdog, const TCHAR* ScopeName, const UObject* Instigator);
+		~FWatchScope();
+
+		FLockOnTargetWatchdogCapture* GetCapture() { return Capture.GetPtrOrNull(); }
+
+	private:
+
+		ULockOnTargetWatchdog* Watchdog;
+		TOptional<FLockOnTargetWatchdogCapture> Capture;
+	};
+
+public: /** Config */
+
+	/** Whether calls are watched. */
+	UPROPERTY(Config)
+	bool bEnabled;
+
+	/** Calls longer than this are written to disk. */
+	UPROPERTY(Config)
+	float ThresholdMs;
+
+	/** Limits the number of written captures per World to avoid flooding the disk with a persistent spike. */
+	UPROPERTY(Config)
+	int32 MaxCapturesPerWorld;
+
+private: /** Internal */
+
+	int32 CapturesWritten;
+
+protected:
+
+	void WriteCapture(const FLockOnTargetWatchdogCapture& Capture, double DurationMs);
+
+protected: /** Overrides */
+
+	//UWorldSubsystem
+	virtual bool DoesSupportWorldType(const EWorldType::Type Type) const override;
+};
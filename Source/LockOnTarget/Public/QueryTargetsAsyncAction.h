@@ -0,0 +1,42 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "TargetQuery.h"
+#include "QueryTargetsAsyncAction.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnTargetQueryCompleted, const TArray<FTargetQueryResult>&, Results);
+
+/**
+ * Runs a UTargetManager query on a background thread and returns the results on the game thread.
+ * Results don't include Targets destroyed in the meantime.
+ */
+UCLASS()
+class LOCKONTARGET_API UQueryTargetsAsyncAction final : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Called on the game thread once the query has finished. */
+	UPROPERTY(BlueprintAssignable)
+	FOnTargetQueryCompleted Completed;
+
+	/** Finds registered Targets matching the query without blocking the game thread. */
+	UFUNCTION(BlueprintCallable, Category = "LockOnTarget Manager", meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject"))
+	static UQueryTargetsAsyncAction* QueryTargetsAsync(UObject* WorldContextObject, const FTargetQuery& Query);
+
+	//UBlueprintAsyncActionBase
+	virtual void Activate() override;
+
+private:
+
+	UPROPERTY(Transient)
+	TObjectPtr<UWorld> World;
+
+	FTargetQuery Query;
+
+	void OnQueryCompleted(TArray<FTargetQueryResult>&& Results);
+};
@@ -5,11 +5,13 @@
 #include "LockOnTargetTypes.h"
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
+#include "UObject/SoftObjectPath.h"
 #include "TargetComponent.generated.h"
 
 class ULockOnTargetComponent;
 class UTargetComponent;
 class USceneComponent;
+class FObjectPreSaveContext;
 class UTargetManager;
 class UUserWidget;
 
@@ -25,12 +27,39 @@ enum class EFocusPoint : uint8
 	Custom			UMETA(ToolTip = "GetCustomFocusPoint() will be called. ")
 };
 
+/**
+ * Socket resolved against the TrackedMeshComponent on save, so that the runtime can skip the socket name resolution.
+ */
+USTRUCT()
+struct LOCKONTARGET_API FBakedTargetSocket
+{
+	GENERATED_BODY()
+
+public:
+
+	//Socket this data was resolved for.
+	UPROPERTY()
+	FName Socket = NAME_None;
+
+	//Bone index in the reference skeleton. INDEX_NONE if the location is relative to the component itself.
+	UPROPERTY()
+	int32 BoneIndex = INDEX_NONE;
+
+	//Socket location relative to the bone or the component.
+	UPROPERTY()
+	FVector RelativeLocation = FVector::ZeroVector;
+
+	//Whether the Socket was found in the mesh.
+	UPROPERTY()
+	bool bResolved = false;
+};
+
 /**
  * Represents a Target that ULockOnTargetComponent can capture in conjunction with a Socket.
  * It is kind of a dumping ground for anything LockOnTarget subsystems may need.
  * Has a special FocusPoint concept for tracking systems.
  * 
- * @Note: Not replicated. Take this into account when changing its state.
+ * @Note: Only the compact network ID is replicated (LOT_COMPACT_TARGET_IDS). Take this into account when changing its state.
  * 
  * @see ULockOnTargetComponent.
  */
@@ -119,6 +148,44 @@ private: /** Internal */
 	//Should we skip the TrackedMeshComponent initialization by name.
 	uint8 bSkipMeshInitializationByName : 1;
 
+	//Whether the baked data was made for the mesh asset used by the TrackedMeshComponent.
+	uint8 bUseBakedSockets : 1;
+
+	//Compact ID assigned by the server UTargetManager. Replicated once, 0 if not assigned.
+	UPROPERTY(Transient, ReplicatedUsing = OnRep_NetTargetId)
+	uint32 NetTargetId;
+
+	UFUNCTION()
+	void OnRep_NetTargetId();
+
+	//Recaptures the UTargetManager query entry after the capture state change.
+	void RefreshQueryEntry();
+
+private: /** Baked Sockets */
+
+	//Sockets resolved against the TrackedMeshComponent on save. Indices match the Sockets array.
+	UPROPERTY()
+	TArray<FBakedTargetSocket> BakedSockets;
+
+	//FocusPointCustomSocket resolved against the TrackedMeshComponent on save.
+	UPROPERTY()
+	FBakedTargetSocket BakedFocusPointSocket;
+
+	//Mesh asset the Sockets were resolved against.
+	UPROPERTY()
+	FSoftObjectPath BakedMeshAsset;
+
+	//BakedMeshAsset loaded at validation. Compared with the current mesh asset, which can be changed at runtime.
+	TWeakObjectPtr<const UObject> ValidatedMeshAsset;
+
+public: /** Network */
+
+	/** Compact ID used to reference the Target over the network. 0 if not assigned. */
+	uint32 GetNetTargetId() const { return NetTargetId; }
+
+	/** Used by the server UTargetManager. */
+	void SetNetTargetId(uint32 InNetTargetId) { NetTargetId = InNetTargetId; }
+
 public: /** Target State */
 
 	/** Can the Target be captured by ULockOnTargetComponent. */
@@ -135,10 +202,21 @@ public: /** Target State */
 	UFUNCTION(BlueprintPure, Category = "Target")
 	bool IsCaptured() const;
 
-	/** Gets all ULockOnTargetsComponents that have captured the Target. Usually 1 in a standalone game. */
+	/** Gets all ULockOnTargetsComponents that have captured the Target. Usually 1 in a standalone game. Returns a copy. */
 	UFUNCTION(BlueprintPure, Category = "Target")
 	TArray<ULockOnTargetComponent*> GetInvaders() const;
 
+	/** Gets all Invaders without a copy. */
+	TConstArrayView<ULockOnTargetComponent*> GetInvadersView() const { return Invaders; }
+
+	/** Gets the number of ULockOnTargetComponents that have captured the Target. */
+	UFUNCTION(BlueprintPure, Category = "Target")
+	int32 GetInvadersNum() const { return Invaders.Num(); }
+
+	/** Gets an Invader by index in [0, GetInvadersNum()). Returns nullptr if the index is invalid. */
+	UFUNCTION(BlueprintPure, Category = "Target")
+	ULockOnTargetComponent* GetInvaderAt(int32 Index) const { return Invaders.IsValidIndex(Index) ? Invaders[Index] : nullptr; }
+
 	/** Called to inform the Target that it's been captured by ULockOnTargetComponent. */
 	virtual void CaptureTarget(ULockOnTargetComponent* Instigator);
 
@@ -204,9 +282,31 @@ protected: /** Helpers */
 	USceneComponent* FindMeshComponent() const;
 	USceneComponent* GetRootComponent() const;
 
+	//Checks whether the baked Sockets can be used with the current TrackedMeshComponent.
+	void ValidateBakedSockets();
+	FVector GetBakedSocketLocation(const USceneComponent* Mesh, const FBakedTargetSocket& BakedSocket) const;
+
+#if WITH_EDITOR
+public: /** Editor */
+
+	/** Validates Sockets and FocusPointCustomSocket against the Mesh and bakes the resolved data. Returns false if any Socket doesn't exist. */
+	bool BakeSockets(const USceneComponent* Mesh);
+
+protected:
+
+	//Finds the TrackedMeshComponent of a Blueprint archetype, which doesn't have an owner.
+	USceneComponent* FindArchetypeMeshComponent() const;
+#endif
+
 public: /** Overrides */
 
 	//UActorComponent
 	virtual void BeginPlay() override;
 	virtual void EndPlay(EEndPlayReason::Type Reason) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+#if WITH_EDITOR
+	//UObject
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+#endif
 };
@@ -6,6 +6,46 @@
 #include "LockOnTargetTypes.h"
 #include "TargetHandlerBase.generated.h"
 
+/** How the Line of Sight is evaluated by FTargetEvaluationProfile. */
+UENUM(BlueprintType)
+enum class ELineOfSightEvaluation : uint8
+{
+	Full		UMETA(ToolTip = "Each candidate is traced as configured by the TargetHandler."),
+	WinnerOnly	UMETA(ToolTip = "Only the would-be winner is traced. If it fails, the next best candidate is traced, and so on."),
+	None		UMETA(ToolTip = "Nothing is traced.")
+};
+
+/**
+ * Trades the accuracy of FindTarget() for speed, e.g. for cosmetic previews.
+ * TargetHandlers may ignore unsupported options.
+ */
+USTRUCT(BlueprintType)
+struct LOCKONTARGET_API FTargetEvaluationProfile
+{
+	GENERATED_BODY()
+
+public:
+
+	/** How the Line of Sight is evaluated, if the TargetHandler checks it. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Evaluation Profile")
+	ELineOfSightEvaluation LineOfSight = ELineOfSightEvaluation::Full;
+
+	/** Uses the view cone test instead of projecting the Target onto the screen. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Evaluation Profile")
+	bool bUseViewCone = false;
+
+	/** Only the first Socket of each Target is evaluated. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Evaluation Profile")
+	bool bRepresentativeSocketOnly = false;
+
+public:
+
+	bool IsFullAccuracy() const
+	{
+		return LineOfSight == ELineOfSightEvaluation::Full && !bUseViewCone && !bRepresentativeSocketOnly;
+	}
+};
+
 /**
  * LockOnTargetComponent's special abstract module which is used to handle the Target.
  * Responsible for finding and maintaining the Target.
@@ -22,6 +62,21 @@ public:
 
 	UTargetHandlerBase();
 
+public: /** Find Result Reuse */
+
+	/**
+	 * How long a cached Find result (e.g. found by TargetPreviewModule) can be reused by LockOnTargetComponent instead of a new search.
+	 * The cached Target is revalidated before the reuse. 0 disables the reuse.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Find Result Reuse", meta = (ClampMin = 0.f, UIMin = 0.f, ClampMax = 1.f, UIMax = 1.f, Units = "s"))
+	float FindResultLifetime;
+
+private:
+
+	//Last result of the Find request without the player's input.
+	FTargetInfo CachedFindResult;
+	float CachedFindResultTime;
+
 public: /** Target Handler Interface */
 
 	/**
@@ -47,16 +102,43 @@ public: /** Target Handler Interface */
 	UFUNCTION(BlueprintNativeEvent, Category = "LockOnTarget|Target Handler Base", meta = (ForceAsFunction))
 	void HandleTargetException(const FTargetInfo& Target, ETargetExceptionType Exception);
 
+	/** 
+	 * Finds a Target using the evaluation profile. 
+	 * By default, the profile is ignored and FindTarget() is called.
+	 */
+	virtual FTargetInfo FindTargetWithProfile(const FTargetEvaluationProfile& Profile, FVector2D PlayerInput = FVector2D::ZeroVector);
+
 	/** Whether the target meets all the requirements for being captured. */
 	UFUNCTION(BlueprintCallable, Category = "LockOnTarget|Target Handler Base")
 	bool IsTargetValid(const UTargetComponent* Target) const;
 
+	/** Caches the result of FindTarget() made without the player's input while no Target is locked. */
+	void CacheFindResult(const FTargetInfo& Target);
+
+	/** Returns the cached Find result if it's still fresh and passes RevalidateTarget(), otherwise NULL_TARGET. The cache is consumed. */
+	FTargetInfo ConsumeCachedFindResult();
+
+	void ResetCachedFindResult();
+
+protected:
+
+	/**
+	 * Recheck of a previously found Target against everything FindTarget() requires, used to reuse the cached Find result.
+	 * Returns false by default, as only the implementation knows what FindTarget() requires.
+	 */
+	virtual bool RevalidateTarget(const FTargetInfo& Target);
+
 private: /** Internal */
 
 	virtual FTargetInfo FindTarget_Implementation(FVector2D PlayerInput);
 	virtual void CheckTargetState_Implementation(const FTargetInfo& Target, float DeltaTime);
 	virtual void HandleTargetException_Implementation(const FTargetInfo& Target, ETargetExceptionType Exception);
 
+protected: /** Overrides */
+
+	//LockOnTargetModuleProxy
+	virtual void OnTargetLocked(UTargetComponent* Target, FName Socket) override;
+
 public: /** Deprecated */
 
 	/** (Optional) Target is removed from the level. */
@@ -15,6 +15,7 @@ class UTargetComponent;
 class ULockOnTargetComponent;
 class APlayerController;
 class APawn;
+struct FLockOnTargetWatchdogCapture;
 
 /** Target unlock reasons. */
 UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
@@ -168,10 +169,13 @@ public:
  * |FindTargetInternal() - Iterates over TargetComponents (hereinafter a Target).
  * |   |IsTargetable() - Rejects all invalid Targets.
  * |   |IsTargetableCustom() - Custom chance to reject the Target.
- * |   |FindBestSocket() - Finds the best Socket by comparing modifiers.
+ * |   |GatherSocketCandidates() - Collects Sockets with their modifiers as candidates.
+ * |   |   |   (With cluster scoring, Targets are gathered cluster by cluster, best lower bound first.)
  * |   |   |PreModifierCalculation() - Early chance to reject the Socket.
  * |   |   |CalculateModifier() - Calculates the modifier for the Socket.
- * |   |   |PostModifierCalculation() - Last possible chance to reject the Socket.
+ * |SelectBestCandidate() - Checks candidates from the least modifier in batches until one passes.
+ * |   |PostModifierCalculation() - Last possible chance to reject the Socket.
+ * |   |LineOfSightTraceBatch() - Traces the deferred Line of Sight rays of the batch one after another.
  *
  * @see UTargetHandlerBase.
  */ 
@@ -229,6 +233,19 @@ public: /** Solver */
 	UPROPERTY(Config, EditDefaultsOnly, Category = "Advanced Solver", meta = (UIMin = 0.f, ClampMin = 0.f, UIMax = 1.f, ClampMax = 1.f, Units = "x"))
 	float MinimumThreshold;
 
+public: /** Clustering */
+
+	/**
+	 * Scores UTargetManager clusters first and only processes the members of clusters that can beat the current best candidate.
+	 * Ignored if the handler doesn't support it, see SupportsClusterScoring().
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Clustering")
+	bool bClusterScoring;
+
+	/** Minimum number of registered Targets to use the cluster scoring. */
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Clustering", meta = (EditCondition = "bClusterScoring", EditConditionHides, ClampMin = 0, UIMin = 0))
+	int32 MinTargetsForClustering;
+
 public: /** Distance */
 
 	/** Target must be within a certain distance range. UTargetComponent::CaptureRadius. */
@@ -279,6 +296,20 @@ public: /** Target Switching */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Target Switching", meta = (ClampMin = 0.f, ClampMax = 180.f, UIMin = 0.f, UIMax = 180.f, Units = "deg"))
 	float AngleRange;
 
+public: /** Socket Tracking */
+
+	/** While the Target is locked, periodically moves the lock to its best Socket. Only the captured Target's Sockets are scored. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Socket Tracking")
+	bool bTrackBestSocket;
+
+	/** Captured Target Sockets rescoring interval. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Socket Tracking", meta = (EditCondition = "bTrackBestSocket", EditConditionHides, ClampMin = 0.f, UIMin = 0.f, Units = "s"))
+	float SocketTrackingInterval;
+
+	/** The best Socket's modifier must be lower than the captured Socket's one by this ratio. Prevents flickering between similar Sockets. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Socket Tracking", meta = (EditCondition = "bTrackBestSocket", EditConditionHides, ClampMin = 0.f, ClampMax = 1.f, UIMin = 0.f, UIMax = 1.f, Units = "x"))
+	float SocketSwitchHysteresis;
+
 public: /** Line Of Sight */
 
 	/** Target must be successfully traced. */
@@ -300,16 +331,89 @@ public: /** Line Of Sight */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Line Of Sight", meta = (EditCondition = "bLineOfSightCheck && LostTargetDelay > 0", EditConditionHides, Units = "s"))
 	float CheckInterval;
 
+	/** How many of the best candidates have their Line of Sight traced together while finding a Target. */
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Line Of Sight", meta = (EditCondition = "bLineOfSightCheck", EditConditionHides, ClampMin = 1, UIMin = 1, ClampMax = 16, UIMax = 16))
+	int32 LineOfSightBatchSize;
+
+	/** Rejects rays blocked by the terrain before the physics trace using a cached downsampled landscape heightfield. Landscape holes aren't taken into account. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Line Of Sight", meta = (EditCondition = "bLineOfSightCheck", EditConditionHides))
+	bool bLandscapeOcclusionCheck;
+
+	/** How deep the ray must be under the terrain to be treated as blocked. Compensates the heightfield downsampling. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Line Of Sight", meta = (EditCondition = "bLineOfSightCheck && bLandscapeOcclusionCheck", EditConditionHides, ClampMin = 0.f, UIMin = 0.f, Units = "cm"))
+	float LandscapeHeightTolerance;
+
+	/**
+	 * For AI-controlled owners, uses the sight sense of the AIController's PerceptionComponent as the Line of Sight to the Target actor.
+	 * Falls back to the trace if the Target hasn't been sensed by the sight yet.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Line Of Sight", meta = (EditCondition = "bLineOfSightCheck", EditConditionHides))
+	bool bUseAIPerceptionLineOfSight;
+
 public: /** Callbacks */
 
 	/** Will be called when any Target's modifier is calculated. Basically used by FGDC_LockOnTarget to visualize Targets modifiers. */
 	DECLARE_MULTICAST_DELEGATE_TwoParams(FOnModifierCalculated, const struct FFindTargetContext& /*TargetContext*/, float /*Modifier*/);
 	FOnModifierCalculated OnModifierCalculated;
 
+public: /** Last Search */
+
+	/** Sockets gathered by the last Target search, the best first. They've passed the modifier calculation, but not necessarily the final checks. */
+	TConstArrayView<FTargetInfo> GetLastCandidates() const { return LastCandidates; }
+
+	/** World time of the last Target search. */
+	double GetLastCandidatesTime() const { return LastCandidatesTime; }
+
 private: /** Internal */
 	
 	FTimerHandle LineOfSightExpirationHandle;
 	float LineOfSightCheckTimer;
+	float SocketTrackingTimer;
+
+	//Socket that passed the modifier calculation and waits for PostModifierCalculationCheck().
+	struct FTargetCandidate
+	{
+		FTargetContext Target;
+		float DeltaAngle2D = 0.f;
+		float Modifier = FLT_MAX;
+
+		//Has already passed the checks in an earlier pass over the clusters.
+		bool bVerified = false;
+	};
+
+	//Line of Sight ray deferred to be traced with the whole batch.
+	struct FLineOfSightRay
+	{
+		FVector From = FVector::ZeroVector;
+		FVector To = FVector::ZeroVector;
+		const AActor* TargetToIgnore = nullptr;
+		int32 CandidateIndex = INDEX_NONE;
+		bool bIsClear = false;
+	};
+
+	//Reused between searches to avoid allocations.
+	TArray<FTargetCandidate> Candidates;
+	mutable TArray<FLineOfSightRay> PendingLineOfSightRays;
+
+	//Whether PostModifierCalculationCheck() should defer the Line of Sight trace to the batch.
+	bool bDeferLineOfSight;
+	int32 CurrentCandidateIndex;
+
+	//Evaluation profile of the current FindTargetWithProfile() call. nullptr means the full accuracy.
+	const FTargetEvaluationProfile* ActiveProfile;
+
+	//Capture of the currently watched call. nullptr if the watchdog is disabled.
+	FLockOnTargetWatchdogCapture* WatchdogCapture;
+
+	//Stats of the current search or check for the trace and telemetry.
+	int32 SearchCandidatesNum;
+	mutable int32 SearchTracesNum;
+
+	//Sorted candidates of the last search for the other consumers, e.g. the Niagara data interface.
+	UPROPERTY(Transient)
+	TArray<FTargetInfo> LastCandidates;
+
+	double LastCandidatesTime;
 
 protected: /** Finding */
 
@@ -328,8 +432,44 @@ protected: /** Finding */
 	bool IsTargetableCustom(const UTargetComponent* TargetComponent) const;
 	virtual bool IsTargetableCustom_Implementation(const UTargetComponent* TargetComponent) const;
 
-	/** Finds the best Socket by comparing modifiers. */
-	void FindBestSocket(FTargetModifier& BestTarget, FFindTargetContext& TargetContext);
+	/** Collects the Target's Sockets that passed the modifier calculation as candidates. */
+	void GatherSocketCandidates(FFindTargetContext& TargetContext);
+
+	/** Runs PostModifierCalculationCheck() over the sorted candidates in batches. Failed candidates are removed, so on success the first candidate is the best one. */
+	bool SelectBestCandidate(FFindTargetContext& TargetContext);
+
+	/** FindTargetInternal() over UTargetManager clusters. */
+	FTargetInfo FindTargetInClusters(FFindTargetContext& TargetContext);
+
+	/** The least modifier that any Socket of the cluster can have with the default solver. */
+	float CalculateClusterModifierLowerBound(const FFindTargetContext& TargetContext, const struct FTargetCluster& Cluster) const;
+
+	/** Copies the current candidates to the watchdog capture. */
+	void RecordWatchdogCandidates() const;
+
+	/** Copies the current candidates to LastCandidates before they're checked. */
+	void RecordLastCandidates();
+
+	/** Counts a BlueprintNativeEvent call for the watchdog capture. */
+	void NoteWatchdogHookCall() const;
+
+	/** Counts Line of Sight rays that reached the physics scene for the watchdog and the trace. */
+	void NoteTracesIssued(int32 NumTraces) const;
+
+	/** Whether the cluster scoring can be used for the current search. */
+	bool CanUseClusterScoring() const;
+
+	/**
+	 * Whether the cluster lower bound matches CalculateTargetModifier(). The bound relies on the default solver,
+	 * so only this class returns true unless the modifier is overridden in Blueprint.
+	 * Native subclasses have to opt in explicitly, and only if their modifier isn't lower than the default one.
+	 */
+	virtual bool SupportsClusterScoring() const;
+
+	/** Evaluation options of the current search, affected by the active profile and the governor. */
+	bool ShouldUseScreenCapture() const;
+	bool ShouldTraceCandidates() const;
+	bool ShouldUseRepresentativeSocketOnly() const;
 
 	/** Rejects the Target after processing the Socket. */
 	virtual bool PreModifierCalculationCheck(const FFindTargetContext& TargetContext) const;
@@ -339,7 +479,12 @@ protected: /** Finding */
 	float CalculateTargetModifier(const FFindTargetContext& TargetContext) const;
 	virtual float CalculateTargetModifier_Implementation(const FFindTargetContext& TargetContext) const;
 
-	/** Last possible chance to reject the Socket. Expensive operations should be here. Some checks might spend more CPU time than calculating the modifier. */
+	/**
+	 * Last possible chance to reject the Socket. Expensive operations should be here. Some checks might spend more CPU time than calculating the modifier.
+	 * While finding a Target, the default implementation doesn't trace the Line of Sight but defers it to the batch, which is traced afterwards.
+	 * So true from the parent call doesn't mean that the Socket is visible yet, the Socket is still rejected if its ray turns out blocked.
+	 * Overrides that depend on the Line of Sight result should trace it themselves.
+	 */
 	UFUNCTION(BlueprintNativeEvent, Category = "LockOnTarget|Third Person Target Handler")
 	bool PostModifierCalculationCheck(const FFindTargetContext& TargetContext) const;
 	virtual bool PostModifierCalculationCheck_Implementation(const FFindTargetContext& TargetContext) const;
@@ -362,6 +507,11 @@ protected: /** Helpers */
 	void GetPointOfView(FVector& OutLocation, FVector& OutDirection) const;
 	virtual void GetPointOfView_Implementation(FVector& OutLocation, FVector& OutDirection) const;
 
+protected: /** Socket Tracking */
+
+	/** Rescores the captured Target's Sockets and switches to the best one if it's noticeably better. */
+	virtual void UpdateTrackedSocket(const FTargetInfo& Target);
+
 protected: /** Line Of Sight */
 
 	virtual void StartLineOfSightTimer();
@@ -369,12 +519,26 @@ protected: /** Line Of Sight */
 	virtual void OnLineOfSightExpiration();
 	bool LineOfSightTrace(const FVector& From, const FVector& To, const AActor* const TargetToIgnore) const;
 
+	//Whether the ray is definitely blocked by the terrain. Doesn't issue any physics query.
+	bool IsBlockedByLandscape(const FVector& From, const FVector& To) const;
+
+	//Reads the Line of Sight from the AIPerception sight sense. Returns false if perception has no info about the Target.
+	bool GetPerceivedLineOfSight(const AActor* const TargetActor, bool& bOutIsVisible) const;
+
+	//Object types to trace, read from TraceObjectChannels on each call so that runtime changes are respected.
+	FCollisionObjectQueryParams MakeLineOfSightObjectParams() const;
+
+	//Traces the rays one after another with shared query params. Rays resolved by perception or blocked by the terrain skip the physics query.
+	void LineOfSightTraceBatch(TArrayView<FLineOfSightRay> Rays) const;
+
 protected: /** Overrides */
 
 	//TargetHandlerBase
 	virtual FTargetInfo FindTarget_Implementation(FVector2D PlayerInput) override;
+	virtual FTargetInfo FindTargetWithProfile(const FTargetEvaluationProfile& Profile, FVector2D PlayerInput) override;
 	virtual void CheckTargetState_Implementation(const FTargetInfo& Target, float DeltaTime) override;
 	virtual void HandleTargetException_Implementation(const FTargetInfo& Target, ETargetExceptionType Exception) override;
+	virtual bool RevalidateTarget(const FTargetInfo& Target) override;
 
 	//LockOnTargetModuleBase
 	virtual void OnTargetUnlocked(UTargetComponent* UnlockedTarget, FName Socket) override;
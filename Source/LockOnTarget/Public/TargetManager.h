@@ -4,16 +4,67 @@
 
 #include "CoreMinimal.h"
 #include "LockOnTargetTypes.h"
+#include "TargetQuery.h"
 #include "Subsystems/WorldSubsystem.h"
 #include "TargetManager.generated.h"
 
 class UTargetComponent;
+class ULockOnTargetComponent;
 class UWorld;
+class USceneComponent;
+enum class EUpdateTransformFlags : int32;
+enum class ETeleportType : uint8;
+
+/**
+ * Coarse spatial group of nearby Targets.
+ */
+struct LOCKONTARGET_API FTargetCluster
+{
+	//Center of the bounding sphere.
+	FVector Center = FVector::ZeroVector;
+
+	//Radius of the bounding sphere. Encloses the members' tracked mesh bounds and actor locations, padded by ClusterBoundsPadding.
+	float Radius = 0.f;
+
+	//The biggest UTargetComponent::CaptureRadius among the members.
+	float MaxCaptureRadius = 0.f;
+
+	TArray<UTargetComponent*> Members;
+};
+
+/**
+ * FocusPoint of a Target evaluated by UTargetManager for focus consumers.
+ */
+struct LOCKONTARGET_API FTargetFocusSample
+{
+	FVector Location = FVector::ZeroVector;
+
+	//Derived from the previous evaluation. The owner velocity is used for the first one.
+	FVector Velocity = FVector::ZeroVector;
+
+	//False if the Target has been unregistered.
+	bool bValid = false;
+};
+
+/**
+ * Handle of a focus consumer registered in UTargetManager.
+ */
+struct LOCKONTARGET_API FTargetFocusHandle
+{
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+private:
+
+	friend class UTargetManager;
+
+	int32 Index = INDEX_NONE;
+	uint32 Serial = 0;
+};
 
 /** 
  * A simple manager that keeps track of registered Targets.
  */
-UCLASS()
+UCLASS(Config = Game)
 class LOCKONTARGET_API UTargetManager final : public UWorldSubsystem
 {
 	GENERATED_BODY()
@@ -30,7 +81,7 @@ public:
 	bool UnregisterTarget(UTargetComponent* Target);
 	bool IsTargetRegistered(UTargetComponent * Target) const { return Targets.Contains(Target); }
 
-	//Get all registered Targets
+	//Get all registered Targets. Blueprint gets a copy of the set on each call, prefer GetTargetAt() or GetTargetsPage().
 	UFUNCTION(BlueprintCallable, Category = "LockOnTarget Manager")
 	const TSet<UTargetComponent*>& GetAllTargets() const { return Targets; }
 
@@ -38,6 +89,88 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "LockOnTarget Manager")
 	int32 GetTargetsNum() const { return Targets.Num(); }
 
+	//Get all registered Targets as a dense array without a copy. The order changes on unregistration.
+	TConstArrayView<UTargetComponent*> GetTargetsView() const { return DenseTargets; }
+
+	//Get a registered Target by index in [0, GetTargetsNum()). Returns nullptr if the index is invalid.
+	UFUNCTION(BlueprintPure, Category = "LockOnTarget Manager")
+	UTargetComponent* GetTargetAt(int32 Index) const { return DenseTargets.IsValidIndex(Index) ? DenseTargets[Index] : nullptr; }
+
+	//Get up to Count registered Targets starting at StartIndex. Lets Blueprint walk the registry in pages.
+	UFUNCTION(BlueprintCallable, Category = "LockOnTarget Manager")
+	void GetTargetsPage(int32 StartIndex, int32 Count, TArray<UTargetComponent*>& OutTargets) const;
+
+public: /** Network IDs */
+
+	/**
+	 * The server assigns each Target a compact ID: 16 bits of the slot index and 8 bits of the slot generation.
+	 * The ID is replicated once with the Target, so FTargetInfo is sent as the ID and resolved on the client in O(1).
+	 */
+	static constexpr uint32 NetTargetIndexBits = 16;
+	static constexpr uint32 NetTargetGenerationBits = 8;
+	static constexpr uint32 NetTargetIdBits = NetTargetIndexBits + NetTargetGenerationBits;
+
+	/** Gets the registered Target by its ID or nullptr if the ID isn't known, e.g. not received yet or stale. */
+	UTargetComponent* ResolveNetTargetId(uint32 NetTargetId) const;
+
+	/** Maps the ID received by the Target on the client. */
+	void MapNetTargetId(UTargetComponent* Target);
+
+	/** Resolves the instigator's Target once the pending ID is mapped. */
+	void AddPendingNetInstigator(ULockOnTargetComponent* Instigator);
+
+public: /** Clusters */
+
+	/** Size of the grid cell which groups Targets into a cluster. */
+	UPROPERTY(Config)
+	float ClusterCellSize;
+
+	/**
+	 * Added to the cluster radius. Bounds are only refreshed when the Targets move,
+	 * so the padding keeps animated Sockets (e.g. raised arms) inside the cluster sphere in the meantime.
+	 */
+	UPROPERTY(Config)
+	float ClusterBoundsPadding;
+
+	/**
+	 * Gets Targets grouped by grid cells. Clusters are maintained only once requested and updated at most once per frame.
+	 * Only the Targets which have moved since the last update are processed, and only the touched clusters refresh their bounds.
+	 */
+	const TMap<FIntVector, FTargetCluster>& GetClusters();
+
+public: /** Focus Consumers */
+
+	/**
+	 * Registers a bulk consumer of the Target FocusPoint, e.g. a homing projectile.
+	 * Consumers of the same Target and Instigator share a single evaluation per frame.
+	 * Instigator is passed to UTargetComponent::GetFocusLocation() and may be null.
+	 */
+	FTargetFocusHandle RegisterFocusConsumer(UTargetComponent* Target, const ULockOnTargetComponent* Instigator = nullptr);
+	void UnregisterFocusConsumer(FTargetFocusHandle& Handle);
+
+	/** Returns the sample of the consumer or nullptr if the handle isn't registered. Samples are evaluated at most once per frame. */
+	const FTargetFocusSample* GetFocusSample(const FTargetFocusHandle& Handle);
+
+	/** Returns all samples for bulk reading. Empty slots are invalid. Indices are stable while the consumer is registered. */
+	TConstArrayView<FTargetFocusSample> GetFocusSamples();
+	int32 GetFocusSampleIndex(const FTargetFocusHandle& Handle) const;
+
+public: /** Queries */
+
+	/** Finds registered Targets matching the query. Runs on the captured Target state, see GetQueryEntries(). */
+	UFUNCTION(BlueprintCallable, Category = "LockOnTarget Manager")
+	void QueryTargets(const FTargetQuery& Query, TArray<FTargetQueryResult>& OutResults);
+
+	/**
+	 * Gets the Target state used by the queries. Entries are maintained only once requested.
+	 * A Target is captured on registration and on its capture state changes, only the location follows its movement.
+	 */
+	TConstArrayView<FTargetQueryEntry> GetQueryEntries();
+
+	/** Recaptures the query entry of the Target. Should be called after changing the owner's Tags or team, which aren't tracked. */
+	UFUNCTION(BlueprintCallable, Category = "LockOnTarget Manager")
+	void RefreshQueryEntry(UTargetComponent* Target);
+
 protected: /** Overrides */
 	
 	//UWorldSubsystem
@@ -48,4 +181,97 @@ private: /** Internal */
 
 	//All registered Targets.
 	TSet<UTargetComponent*> Targets;
+
+	//Registered Targets in a dense array for the indexed access and cache friendly iteration.
+	TArray<UTargetComponent*> DenseTargets;
+
+	//Cell of a clustered Target and the binding which reports its movement.
+	struct FClusteredTarget
+	{
+		FIntVector Cell = FIntVector::ZeroValue;
+		TWeakObjectPtr<USceneComponent> Root;
+		FDelegateHandle TransformUpdatedHandle;
+		bool bHasCell = false;
+		bool bDirty = false;
+	};
+
+	//Clusters by grid cells and the state of each clustered Target.
+	TMap<FIntVector, FTargetCluster> Clusters;
+	TMap<UTargetComponent*, FClusteredTarget> ClusteredTargets;
+
+	//Targets moved since the last update and the cells which need new bounds.
+	TArray<UTargetComponent*> DirtyClusterTargets;
+	TSet<FIntVector> TouchedClusterCells;
+
+	uint64 ClustersUpdateFrame;
+	bool bClustersMaintained;
+
+	void UpdateClusters();
+	void TrackClusterTarget(UTargetComponent* Target);
+	void UntrackClusterTarget(UTargetComponent* Target);
+	void OnClusterTargetMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, UTargetComponent* Target);
+	void RemoveFromCluster(UTargetComponent* Target, const FIntVector& Cell);
+	static void RefreshClusterBounds(FTargetCluster& Cluster, float Padding);
+
+	//Unique Target and Instigator pair evaluated for its consumers.
+	struct FFocusEntry
+	{
+		//Null once the Target is unregistered.
+		UTargetComponent* Target = nullptr;
+		TWeakObjectPtr<const ULockOnTargetComponent> Instigator;
+		const ULockOnTargetComponent* InstigatorKey = nullptr;
+		int32 NumConsumers = 0;
+	};
+
+	struct FFocusConsumer
+	{
+		int32 EntryIndex = INDEX_NONE;
+		uint32 Serial = 0;
+	};
+
+	//Entries and samples share indices.
+	TSparseArray<FFocusEntry> FocusEntries;
+	TArray<FTargetFocusSample> FocusSamples;
+	TMap<TPair<const UTargetComponent*, const ULockOnTargetComponent*>, int32> FocusEntryIndices;
+	TSparseArray<FFocusConsumer> FocusConsumers;
+	uint32 FocusConsumerSerial;
+	uint64 FocusUpdateFrame;
+	double FocusUpdateTime;
+
+	//Query entry index of a Target and the binding which refreshes its location.
+	struct FQueryTarget
+	{
+		int32 EntryIndex = INDEX_NONE;
+		TWeakObjectPtr<USceneComponent> Root;
+		FDelegateHandle TransformUpdatedHandle;
+	};
+
+	//Entries are removed by a swap with the last one.
+	TArray<FTargetQueryEntry> QueryEntries;
+	TMap<UTargetComponent*, FQueryTarget> QueryTargetEntries;
+	bool bQueryEntriesMaintained;
+
+	void TrackQueryTarget(UTargetComponent* Target);
+	void UntrackQueryTarget(UTargetComponent* Target);
+	void OnQueryTargetMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, UTargetComponent* Target);
+	static void CaptureQueryEntry(UTargetComponent* Target, FTargetQueryEntry& Entry);
+
+	//Targets by the network ID slot. Assigned on the server, mapped on the client.
+	struct FNetTargetSlot
+	{
+		UTargetComponent* Target = nullptr;
+		uint8 Generation = 0;
+	};
+
+	TArray<FNetTargetSlot> NetTargetSlots;
+	TArray<uint16> FreeNetTargetSlots;
+
+	//Instigators which have received an ID not mapped yet.
+	TArray<TWeakObjectPtr<ULockOnTargetComponent>> PendingNetInstigators;
+
+	void AssignNetTargetId(UTargetComponent* Target);
+	void ReleaseNetTargetId(UTargetComponent* Target);
+
+	const FFocusConsumer* FindFocusConsumer(const FTargetFocusHandle& Handle) const;
+	void UpdateFocusSamples();
 };
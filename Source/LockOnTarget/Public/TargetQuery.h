@@ -0,0 +1,124 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TargetQuery.generated.h"
+
+class UTargetComponent;
+
+/** Order of the query results. */
+UENUM(BlueprintType)
+enum class ETargetQuerySort : uint8
+{
+	None		UMETA(ToolTip = "Results are in the arbitrary order."),
+	Distance	UMETA(ToolTip = "The closest Targets first."),
+	Angle		UMETA(ToolTip = "Targets closest to the cone direction first. Requires the cone.")
+};
+
+/** Team filter of the query. */
+UENUM(BlueprintType)
+enum class ETargetQueryTeamFilter : uint8
+{
+	Any,
+	SameTeam	UMETA(ToolTip = "Only Targets of the query TeamId."),
+	OtherTeams	UMETA(ToolTip = "Only Targets not of the query TeamId.")
+};
+
+/**
+ * Declarative filter of Targets registered in UTargetManager.
+ */
+USTRUCT(BlueprintType)
+struct LOCKONTARGET_API FTargetQuery
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Query origin. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Query")
+	FVector Location = FVector::ZeroVector;
+
+	/** Targets farther than this radius from the origin are filtered out. 0 disables the radius. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Query", meta = (ClampMin = 0.f, UIMin = 0.f, Units = "cm"))
+	float Radius = 0.f;
+
+	/** Cone direction. Zero disables the cone. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Query")
+	FVector ConeDirection = FVector::ZeroVector;
+
+	/** Cone half angle. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Query", meta = (ClampMin = 0.f, ClampMax = 180.f, UIMin = 0.f, UIMax = 180.f, Units = "deg"))
+	float ConeHalfAngle = 45.f;
+
+	/** Only Targets which can be captured. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Query")
+	bool bOnlyCapturable = true;
+
+	/** Filters out Targets captured by any ULockOnTargetComponent. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Query")
+	bool bExcludeCaptured = false;
+
+	/** The owner of the Target should have all these actor tags. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Query")
+	TArray<FName> RequiredTags;
+
+	/** The owner of the Target shouldn't have any of these actor tags. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Query")
+	TArray<FName> ExcludedTags;
+
+	/** Team filter against TeamId. Teams are read from the owners implementing IGenericTeamAgentInterface. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Query")
+	ETargetQueryTeamFilter TeamFilter = ETargetQueryTeamFilter::Any;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Query", meta = (EditCondition = "TeamFilter != ETargetQueryTeamFilter::Any"))
+	uint8 TeamId = 255;
+
+	/** Order of the results. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Query")
+	ETargetQuerySort Sort = ETargetQuerySort::Distance;
+
+	/** The maximum number of the results after sorting. 0 means unlimited. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Query", meta = (ClampMin = 0, UIMin = 0))
+	int32 MaxResults = 0;
+};
+
+USTRUCT(BlueprintType)
+struct LOCKONTARGET_API FTargetQueryResult
+{
+	GENERATED_BODY()
+
+public:
+
+	//Weak, as the results might outlive the Target, e.g. in the async query.
+	UPROPERTY(BlueprintReadOnly, Category = "Target Query")
+	TWeakObjectPtr<UTargetComponent> Target = nullptr;
+
+	/** Distance from the query origin to the owner. */
+	UPROPERTY(BlueprintReadOnly, Category = "Target Query")
+	float Distance = 0.f;
+
+	/** Angle between the cone direction and the owner. 0 if the cone is disabled. */
+	UPROPERTY(BlueprintReadOnly, Category = "Target Query")
+	float Angle = 0.f;
+};
+
+/**
+ * Target state captured by UTargetManager for the queries. Safe to read off the game thread.
+ * The Target is only copied off the game thread, never resolved.
+ */
+struct LOCKONTARGET_API FTargetQueryEntry
+{
+	TWeakObjectPtr<UTargetComponent> Target;
+	FVector Location = FVector::ZeroVector;
+	TArray<FName> Tags;
+	uint8 TeamId = 255;
+	bool bCanBeCaptured = false;
+	bool bIsCaptured = false;
+};
+
+namespace TargetQuery
+{
+	/** Filters, sorts and limits the entries. Thread safe. Large sets are filtered in parallel. */
+	LOCKONTARGET_API void Execute(TConstArrayView<FTargetQueryEntry> Entries, const FTargetQuery& Query, TArray<FTargetQueryResult>& OutResults);
+}
@@ -142,7 +142,7 @@ FString FGDC_LockOnTarget::CollectInvadersInfo() const
 
 	if(LockOn->IsTargetLocked())
 	{
-		const auto& Invaders = LockOn->GetTargetComponent()->GetInvaders();
+		const auto& Invaders = LockOn->GetTargetComponent()->GetInvadersView();
 
 		for (int i = 0; i < Invaders.Num(); ++i)
 		{
@@ -0,0 +1,122 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "StressTargets/LockOnTargetStressActor.h"
+#include "TargetComponent.h"
+
+static const FName StressSocketBaseName(TEXT("StressSocket"));
+
+/*******************************************************************************************/
+/*******************************  Socket Component  ****************************************/
+/*******************************************************************************************/
+
+ULockOnTargetStressSocketComponent::ULockOnTargetStressSocketComponent()
+	: NumSockets(0)
+	, SocketSpacing(40.f)
+{
+}
+
+FName ULockOnTargetStressSocketComponent::GetSocketName(int32 SocketIndex)
+{
+	//FName number suffix avoids building strings for each Socket.
+	return FName(StressSocketBaseName, NAME_EXTERNAL_TO_INTERNAL(SocketIndex));
+}
+
+int32 ULockOnTargetStressSocketComponent::GetSocketIndex(FName SocketName) const
+{
+	if (SocketName.GetComparisonIndex() == StressSocketBaseName.GetComparisonIndex())
+	{
+		const int32 SocketIndex = NAME_INTERNAL_TO_EXTERNAL(SocketName.GetNumber());
+		return SocketIndex >= 0 && SocketIndex < NumSockets ? SocketIndex : INDEX_NONE;
+	}
+
+	return INDEX_NONE;
+}
+
+bool ULockOnTargetStressSocketComponent::HasAnySockets() const
+{
+	return NumSockets > 0;
+}
+
+bool ULockOnTargetStressSocketComponent::DoesSocketExist(FName InSocketName) const
+{
+	return GetSocketIndex(InSocketName) != INDEX_NONE;
+}
+
+FTransform ULockOnTargetStressSocketComponent::GetSocketTransform(FName InSocketName, ERelativeTransformSpace TransformSpace) const
+{
+	const int32 SocketIndex = GetSocketIndex(InSocketName);
+
+	if (SocketIndex == INDEX_NONE)
+	{
+		return Super::GetSocketTransform(InSocketName, TransformSpace);
+	}
+
+	const FTransform SocketTransform(FVector(0.f, 0.f, SocketSpacing * (SocketIndex + 1)));
+
+	switch (TransformSpace)
+	{
+	case RTS_World:		return SocketTransform * GetComponentTransform();
+	case RTS_Actor:		return SocketTransform * GetComponentTransform().GetRelativeTransform(GetOwner()->GetActorTransform());
+	default:			return SocketTransform;
+	}
+}
+
+void ULockOnTargetStressSocketComponent::QuerySupportedSockets(TArray<FComponentSocketDescription>& OutSockets) const
+{
+	for (int32 i = 0; i < NumSockets; ++i)
+	{
+		OutSockets.Emplace(GetSocketName(i), EComponentSocketType::Socket);
+	}
+}
+
+/*******************************************************************************************/
+/*******************************  Stress Actor  ********************************************/
+/*******************************************************************************************/
+
+ALockOnTargetStressActor::ALockOnTargetStressActor()
+	: OrbitCenter(0.f)
+	, OrbitRadius(0.f)
+	, AngularSpeed(0.f)
+	, OrbitAngle(0.f)
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	//Targets must be referenced over the network in networked sessions.
+	bReplicates = true;
+	SetReplicatingMovement(true);
+
+	SocketComponent = CreateDefaultSubobject<ULockOnTargetStressSocketComponent>(TEXT("SocketComponent"));
+	SetRootComponent(SocketComponent);
+
+	TargetComponent = CreateDefaultSubobject<UTargetComponent>(TEXT("TargetComponent"));
+}
+
+void ALockOnTargetStressActor::SetupSockets(int32 NumSockets)
+{
+	//The default None Socket (the actor location) is one of the Sockets.
+	SocketComponent->NumSockets = FMath::Max(NumSockets - 1, 0);
+
+	for (int32 i = 0; i < SocketComponent->NumSockets; ++i)
+	{
+		TargetComponent->AddSocket(ULockOnTargetStressSocketComponent::GetSocketName(i));
+	}
+}
+
+void ALockOnTargetStressActor::StartMoving(float InOrbitRadius, float InAngularSpeed)
+{
+	OrbitRadius = InOrbitRadius;
+	AngularSpeed = InAngularSpeed;
+	OrbitAngle = FMath::FRandRange(0.f, 2.f * PI);
+	OrbitCenter = GetActorLocation() - FVector(FMath::Cos(OrbitAngle), FMath::Sin(OrbitAngle), 0.f) * OrbitRadius;
+
+	SetActorTickEnabled(true);
+}
+
+void ALockOnTargetStressActor::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	OrbitAngle = FMath::Fmod(OrbitAngle + AngularSpeed * DeltaTime, 2.f * PI);
+	SetActorLocation(OrbitCenter + FVector(FMath::Cos(OrbitAngle), FMath::Sin(OrbitAngle), 0.f) * OrbitRadius);
+}
@@ -0,0 +1,85 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Components/SceneComponent.h"
+#include "LockOnTargetStressActor.generated.h"
+
+class UTargetComponent;
+
+/**
+ * Mesh-less scene component that provides procedural Sockets stacked above the component.
+ * Lets synthetic Targets have several Sockets without any asset.
+ */
+UCLASS(NotBlueprintable, ClassGroup = LockOnTarget)
+class ULockOnTargetStressSocketComponent : public USceneComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	ULockOnTargetStressSocketComponent();
+
+	/** Number of procedural Sockets. */
+	int32 NumSockets;
+
+	/** Vertical distance between Sockets. */
+	float SocketSpacing;
+
+	static FName GetSocketName(int32 SocketIndex);
+
+protected:
+
+	//Returns INDEX_NONE if the Socket isn't procedural.
+	int32 GetSocketIndex(FName SocketName) const;
+
+public: /** Overrides */
+
+	//USceneComponent
+	virtual bool HasAnySockets() const override;
+	virtual bool DoesSocketExist(FName InSocketName) const override;
+	virtual FTransform GetSocketTransform(FName InSocketName, ERelativeTransformSpace TransformSpace = RTS_World) const override;
+	virtual void QuerySupportedSockets(TArray<FComponentSocketDescription>& OutSockets) const override;
+};
+
+/**
+ * Lightweight synthetic Target spawned by the lot.SpawnStressTargets console command.
+ * Optionally orbits around its spawn location.
+ */
+UCLASS(NotBlueprintable, NotPlaceable, Transient)
+class ALockOnTargetStressActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	ALockOnTargetStressActor();
+
+	/** Adds procedural Sockets to the Target. Must be called after BeginPlay. */
+	void SetupSockets(int32 NumSockets);
+
+	/** Starts orbiting around the current location. */
+	void StartMoving(float InOrbitRadius, float InAngularSpeed);
+
+protected:
+
+	UPROPERTY(VisibleAnywhere, Category = "Stress Target")
+	TObjectPtr<ULockOnTargetStressSocketComponent> SocketComponent;
+
+	UPROPERTY(VisibleAnywhere, Category = "Stress Target")
+	TObjectPtr<UTargetComponent> TargetComponent;
+
+private: /** Movement */
+
+	FVector OrbitCenter;
+	float OrbitRadius;
+	float AngularSpeed;
+	float OrbitAngle;
+
+public: /** Overrides */
+
+	//AActor
+	virtual void Tick(float DeltaTime) override;
+};
@@ -0,0 +1,197 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "StressTargets/LockOnTargetStressSubsystem.h"
+#include "StressTargets/LockOnTargetStressActor.h"
+
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+
+static void SpawnStressTargetsCommand(const TArray<FString>& Args, UWorld* World)
+{
+	ULockOnTargetStressSubsystem* const StressSubsystem = ULockOnTargetStressSubsystem::Get(World);
+
+	if (!StressSubsystem || Args.Num() < 1)
+	{
+		UE_LOG(LogConsoleResponse, Warning, TEXT("Usage: lot.SpawnStressTargets N [Radius] [Sockets] [Moving] [ChurnPerSecond]"));
+		return;
+	}
+
+	if (World->GetNetMode() == NM_Client)
+	{
+		UE_LOG(LogConsoleResponse, Warning, TEXT("lot.SpawnStressTargets must be executed on the server."));
+		return;
+	}
+
+	FLockOnTargetStressParams Params;
+	Params.NumTargets = FMath::Max(FCString::Atoi(*Args[0]), 0);
+
+	if (Args.IsValidIndex(1))
+	{
+		Params.Radius = FMath::Max(FCString::Atof(*Args[1]), 100.f);
+	}
+
+	if (Args.IsValidIndex(2))
+	{
+		Params.NumSockets = FMath::Clamp(FCString::Atoi(*Args[2]), 1, 64);
+	}
+
+	if (Args.IsValidIndex(3))
+	{
+		Params.bMoving = FCString::ToBool(*Args[3]);
+	}
+
+	if (Args.IsValidIndex(4))
+	{
+		Params.ChurnPerSecond = FMath::Max(FCString::Atof(*Args[4]), 0.f);
+	}
+
+	StressSubsystem->SpawnTargets(Params);
+	UE_LOG(LogConsoleResponse, Display, TEXT("LockOnTarget stress Targets: %d."), StressSubsystem->GetNumTargets());
+}
+
+static void ClearStressTargetsCommand(UWorld* World)
+{
+	if (ULockOnTargetStressSubsystem* const StressSubsystem = ULockOnTargetStressSubsystem::Get(World))
+	{
+		StressSubsystem->ClearTargets();
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs SpawnStressTargetsCmd(
+	TEXT("lot.SpawnStressTargets"),
+	TEXT("Spawns synthetic Targets around the player. Usage: lot.SpawnStressTargets N [Radius=5000] [Sockets=1] [Moving=0] [ChurnPerSecond=0]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&SpawnStressTargetsCommand));
+
+static FAutoConsoleCommandWithWorld ClearStressTargetsCmd(
+	TEXT("lot.ClearStressTargets"),
+	TEXT("Destroys all Targets spawned by lot.SpawnStressTargets."),
+	FConsoleCommandWithWorldDelegate::CreateStatic(&ClearStressTargetsCommand));
+
+/*******************************************************************************************/
+/*******************************  Stress Subsystem  ****************************************/
+/*******************************************************************************************/
+
+ULockOnTargetStressSubsystem* ULockOnTargetStressSubsystem::Get(const UWorld* InWorld)
+{
+	return InWorld ? InWorld->GetSubsystem<ThisClass>() : nullptr;
+}
+
+bool ULockOnTargetStressSubsystem::DoesSupportWorldType(const EWorldType::Type Type) const
+{
+	return Type == EWorldType::Game || Type == EWorldType::PIE;
+}
+
+TStatId ULockOnTargetStressSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULockOnTargetStressSubsystem, STATGROUP_Tickables);
+}
+
+void ULockOnTargetStressSubsystem::Deinitialize()
+{
+	ClearTargets();
+	Super::Deinitialize();
+}
+
+void ULockOnTargetStressSubsystem::SpawnTargets(const FLockOnTargetStressParams& InParams)
+{
+	Params = InParams;
+	SpawnCenter = GetPlayerLocation();
+	ChurnAccumulator = 0.f;
+
+	SpawnedTargets.Reserve(SpawnedTargets.Num() + Params.NumTargets);
+
+	for (int32 i = 0; i < Params.NumTargets; ++i)
+	{
+		SpawnTarget();
+	}
+}
+
+void ULockOnTargetStressSubsystem::ClearTargets()
+{
+	for (ALockOnTargetStressActor* const Target : SpawnedTargets)
+	{
+		if (IsValid(Target))
+		{
+			Target->Destroy();
+		}
+	}
+
+	SpawnedTargets.Empty();
+	Params = FLockOnTargetStressParams();
+}
+
+ALockOnTargetStressActor* ULockOnTargetStressSubsystem::SpawnTarget()
+{
+	//Uniform distribution over the disk.
+	const float Distance = Params.Radius * FMath::Sqrt(FMath::FRand());
+	const float Angle = FMath::FRandRange(0.f, 2.f * PI);
+	const FVector Location = SpawnCenter + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * Distance;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.ObjectFlags |= RF_Transient;
+
+	ALockOnTargetStressActor* const Target = GetWorld()->SpawnActor<ALockOnTargetStressActor>(Location, FRotator::ZeroRotator, SpawnParams);
+
+	if (Target)
+	{
+		//Sockets are resolved against the root component, which is only tracked after BeginPlay.
+		Target->SetupSockets(Params.NumSockets);
+
+		if (Params.bMoving)
+		{
+			Target->StartMoving(FMath::FRandRange(100.f, 500.f), FMath::FRandRange(0.5f, 2.f));
+		}
+
+		SpawnedTargets.Add(Target);
+	}
+
+	return Target;
+}
+
+FVector ULockOnTargetStressSubsystem::GetPlayerLocation() const
+{
+	if (const APlayerController* const PlayerController = GetWorld()->GetFirstPlayerController())
+	{
+		if (const APawn* const Pawn = PlayerController->GetPawn())
+		{
+			return Pawn->GetActorLocation();
+		}
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		return ViewLocation;
+	}
+
+	return FVector::ZeroVector;
+}
+
+void ULockOnTargetStressSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (Params.ChurnPerSecond <= 0.f || SpawnedTargets.IsEmpty())
+	{
+		return;
+	}
+
+	ChurnAccumulator += Params.ChurnPerSecond * DeltaTime;
+
+	//Each churn destroys a random Target and spawns a new one to keep the population size.
+	for (; ChurnAccumulator >= 1.f && SpawnedTargets.Num() > 0; ChurnAccumulator -= 1.f)
+	{
+		const int32 Index = FMath::RandHelper(SpawnedTargets.Num());
+
+		if (IsValid(SpawnedTargets[Index]))
+		{
+			SpawnedTargets[Index]->Destroy();
+		}
+
+		SpawnedTargets.RemoveAtSwap(Index);
+		SpawnTarget();
+	}
+}
@@ -0,0 +1,72 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LockOnTargetStressSubsystem.generated.h"
+
+class ALockOnTargetStressActor;
+
+/**
+ * Synthetic Target population parameters.
+ */
+struct FLockOnTargetStressParams
+{
+	int32 NumTargets = 0;
+	float Radius = 5000.f;
+	int32 NumSockets = 1;
+	bool bMoving = false;
+
+	//Targets despawned and respawned per second.
+	float ChurnPerSecond = 0.f;
+};
+
+/**
+ * Spawns and maintains synthetic Targets around the player to measure the lock on cost in real maps.
+ *
+ * Console commands:
+ * lot.SpawnStressTargets N [Radius] [Sockets] [Moving] [ChurnPerSecond]
+ * lot.ClearStressTargets
+ */
+UCLASS()
+class ULockOnTargetStressSubsystem final : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	static ULockOnTargetStressSubsystem* Get(const UWorld* InWorld);
+
+	/** Spawns a new population around the player. Previously spawned Targets are kept. The churn uses the latest parameters. */
+	void SpawnTargets(const FLockOnTargetStressParams& InParams);
+
+	/** Destroys all spawned Targets and stops the churn. */
+	void ClearTargets();
+
+	int32 GetNumTargets() const { return SpawnedTargets.Num(); }
+
+private: /** Internal */
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<ALockOnTargetStressActor>> SpawnedTargets;
+
+	FLockOnTargetStressParams Params;
+	FVector SpawnCenter = FVector::ZeroVector;
+	float ChurnAccumulator = 0.f;
+
+protected:
+
+	ALockOnTargetStressActor* SpawnTarget();
+	FVector GetPlayerLocation() const;
+
+protected: /** Overrides */
+
+	//UTickableWorldSubsystem
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	//UWorldSubsystem
+	virtual bool DoesSupportWorldType(const EWorldType::Type Type) const override;
+	virtual void Deinitialize() override;
+};
@@ -22,6 +22,9 @@ public class LockOnTargetEditor : ModuleRules
                 "PropertyEditor",
                 "UnrealEd",
                 "SceneOutliner", //SSocketChooserPopup
+                "TraceAnalysis",
+                "TraceServices",
+                "TraceInsights",
 
             }
             );
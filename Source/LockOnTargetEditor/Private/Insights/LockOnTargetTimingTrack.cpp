@@ -0,0 +1,272 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "Insights/LockOnTargetTimingTrack.h"
+#include "Insights/LockOnTargetTraceProvider.h"
+
+#include "Insights/ITimingViewSession.h"
+#include "Insights/ViewModels/TimingEvent.h"
+#include "Insights/ViewModels/TimingEventSearch.h"
+#include "Insights/ViewModels/TimingTrackViewport.h"
+#include "Insights/ViewModels/TooltipDrawState.h"
+#include "Insights/ViewModels/ITimingViewDrawHelper.h"
+#include "TraceServices/Model/AnalysisSession.h"
+
+#include "Algo/BinarySearch.h"
+
+INSIGHTS_IMPLEMENT_RTTI(FLockOnTargetTimingTrack)
+
+//Items are sorted by their start times and only the last one might be open, i.e. last until the end of the session.
+//Closed items are at most MaxDuration long, so the first visible one starts no earlier than MaxDuration before the viewport.
+template <typename ItemType, typename CallbackType>
+static bool EnumerateRow(const TArray<ItemType>& Items, double MaxDuration, double StartTime, double EndTime, double SessionEndTime, uint32 Row, CallbackType& Callback)
+{
+	const bool bIsLastOpen = Items.Num() > 0 && Items.Last().EndTime == TNumericLimits<double>::Max();
+	const int32 NumClosed = bIsLastOpen ? Items.Num() - 1 : Items.Num();
+
+	const TArrayView<const ItemType> ClosedItems(Items.GetData(), NumClosed);
+	for (int32 Index = Algo::LowerBoundBy(ClosedItems, StartTime - MaxDuration, &ItemType::StartTime); Index < NumClosed && Items[Index].StartTime <= EndTime; ++Index)
+	{
+		if (Items[Index].EndTime < StartTime)
+		{
+			continue;
+		}
+
+		if (!Callback(Items[Index].StartTime, Items[Index].EndTime, Row, Index))
+		{
+			return false;
+		}
+	}
+
+	if (bIsLastOpen && Items.Last().StartTime <= EndTime && SessionEndTime >= StartTime)
+	{
+		return Callback(Items.Last().StartTime, SessionEndTime, Row, NumClosed);
+	}
+
+	return true;
+}
+
+FLockOnTargetTimingTrack::FLockOnTargetTimingTrack(const TraceServices::IAnalysisSession& InSession, uint32 InInstigatorId, const FString& InName)
+	: FTimingEventsTrack(InName)
+	, Session(InSession)
+	, InstigatorId(InInstigatorId)
+{
+}
+
+const FLockOnTargetTimeline* FLockOnTargetTimingTrack::ReadTimeline() const
+{
+	const FLockOnTargetTraceProvider* const Provider = Session.ReadProvider<FLockOnTargetTraceProvider>(FLockOnTargetTraceProvider::ProviderName);
+	return Provider ? Provider->FindTimeline(InstigatorId) : nullptr;
+}
+
+void FLockOnTargetTimingTrack::EnumerateEvents(const FLockOnTargetTimeline& Timeline, double StartTime, double EndTime, FEventCallback Callback) const
+{
+	const double SessionEndTime = Session.GetDurationSeconds();
+
+	EnumerateRow(Timeline.LockSpans, Timeline.MaxLockSpanDuration, StartTime, EndTime, SessionEndTime, Row_Lock, Callback)
+		&& EnumerateRow(Timeline.Searches, Timeline.MaxSearchDuration, StartTime, EndTime, SessionEndTime, Row_Search, Callback)
+		&& EnumerateRow(Timeline.LineOfSightTimers, Timeline.MaxLineOfSightTimerDuration, StartTime, EndTime, SessionEndTime, Row_LineOfSightTimer, Callback)
+		&& EnumerateRow(Timeline.Traces, Timeline.MaxTracesDuration, StartTime, EndTime, SessionEndTime, Row_Traces, Callback);
+}
+
+void FLockOnTargetTimingTrack::BuildDrawState(ITimingEventsTrackDrawStateBuilder& Builder, const ITimingTrackUpdateContext& Context)
+{
+	TraceServices::FAnalysisSessionReadScope SessionReadScope(Session);
+
+	const FLockOnTargetTimeline* const Timeline = ReadTimeline();
+
+	if (!Timeline)
+	{
+		return;
+	}
+
+	const FTimingTrackViewport& Viewport = Context.GetViewport();
+
+	EnumerateEvents(*Timeline, Viewport.GetStartTime(), Viewport.GetEndTime(), [&Builder, Timeline](double StartTime, double EndTime, uint32 Row, int32 Index)
+		{
+			switch (Row)
+			{
+			case Row_Lock:
+			{
+				const FLockOnTargetTimeline::FLockSpan& Span = Timeline->LockSpans[Index];
+				Builder.AddEvent(StartTime, EndTime, Row, *FString::Printf(TEXT("%s [%s]"), Span.TargetName, Span.Socket), 0, FColor(72, 160, 88).ToPackedARGB());
+				break;
+			}
+			case Row_Search:
+			{
+				const FLockOnTargetTimeline::FSearch& Search = Timeline->Searches[Index];
+				const FColor Color = Search.bFound ? FColor(64, 128, 200) : FColor(200, 96, 64);
+				Builder.AddEvent(StartTime, EndTime, Row, *FString::Printf(TEXT("Search: %d candidates, %d traces"), Search.NumCandidates, Search.NumTraces), 0, Color.ToPackedARGB());
+				break;
+			}
+			case Row_LineOfSightTimer:
+			{
+				Builder.AddEvent(StartTime, EndTime, Row, TEXT("Line of Sight lost"), 0, FColor(220, 180, 40).ToPackedARGB());
+				break;
+			}
+			case Row_Traces:
+			{
+				const FLockOnTargetTimeline::FFrameTraces& Traces = Timeline->Traces[Index];
+				Builder.AddEvent(StartTime, EndTime, Row, *FString::Printf(TEXT("%d traces"), Traces.NumTraces), 0, FColor(150, 110, 190).ToPackedARGB());
+				break;
+			}
+			default:
+				break;
+			}
+
+			return true;
+		});
+}
+
+void FLockOnTargetTimingTrack::InitTooltip(FTooltipDrawState& InOutTooltip, const ITimingEvent& InTooltipEvent) const
+{
+	if (!InTooltipEvent.CheckTrack(this) || !InTooltipEvent.Is<FTimingEvent>())
+	{
+		return;
+	}
+
+	const FTimingEvent& TooltipEvent = InTooltipEvent.As<FTimingEvent>();
+
+	TraceServices::FAnalysisSessionReadScope SessionReadScope(Session);
+
+	const FLockOnTargetTimeline* const Timeline = ReadTimeline();
+
+	if (!Timeline)
+	{
+		return;
+	}
+
+	EnumerateEvents(*Timeline, TooltipEvent.GetStartTime(), TooltipEvent.GetEndTime(), [&InOutTooltip, &TooltipEvent, Timeline](double StartTime, double EndTime, uint32 Row, int32 Index)
+		{
+			if (Row != TooltipEvent.GetDepth() || StartTime != TooltipEvent.GetStartTime())
+			{
+				return true;
+			}
+
+			InOutTooltip.ResetContent();
+
+			switch (Row)
+			{
+			case Row_Lock:
+			{
+				const FLockOnTargetTimeline::FLockSpan& Span = Timeline->LockSpans[Index];
+				InOutTooltip.AddTitle(TEXT("Target Locked"));
+				InOutTooltip.AddNameValueTextLine(TEXT("Target:"), Span.TargetName);
+				InOutTooltip.AddNameValueTextLine(TEXT("Socket:"), Span.Socket);
+				break;
+			}
+			case Row_Search:
+			{
+				const FLockOnTargetTimeline::FSearch& Search = Timeline->Searches[Index];
+				InOutTooltip.AddTitle(TEXT("Find Target"));
+				InOutTooltip.AddNameValueTextLine(TEXT("Candidates:"), FString::FromInt(Search.NumCandidates));
+				InOutTooltip.AddNameValueTextLine(TEXT("Traces:"), FString::FromInt(Search.NumTraces));
+				InOutTooltip.AddNameValueTextLine(TEXT("Result:"), Search.bFound ? TEXT("Found") : TEXT("Not found"));
+				break;
+			}
+			case Row_LineOfSightTimer:
+			{
+				InOutTooltip.AddTitle(TEXT("Line of Sight Timer"));
+				break;
+			}
+			case Row_Traces:
+			{
+				const FLockOnTargetTimeline::FFrameTraces& Traces = Timeline->Traces[Index];
+				InOutTooltip.AddTitle(TEXT("Line of Sight Traces"));
+				InOutTooltip.AddNameValueTextLine(TEXT("Frame:"), FString::Printf(TEXT("%llu"), Traces.FrameNumber));
+				InOutTooltip.AddNameValueTextLine(TEXT("Traces:"), FString::FromInt(Traces.NumTraces));
+				break;
+			}
+			default:
+				break;
+			}
+
+			InOutTooltip.AddNameValueTextLine(TEXT("Duration:"), FString::Printf(TEXT("%.3f ms"), (EndTime - StartTime) * 1000.0));
+			InOutTooltip.UpdateLayout();
+
+			return false;
+		});
+}
+
+const TSharedPtr<const ITimingEvent> FLockOnTargetTimingTrack::SearchEvent(const FTimingEventSearchParameters& InSearchParameters) const
+{
+	TSharedPtr<const ITimingEvent> FoundEvent;
+
+	TraceServices::FAnalysisSessionReadScope SessionReadScope(Session);
+
+	if (const FLockOnTargetTimeline* const Timeline = ReadTimeline())
+	{
+		EnumerateEvents(*Timeline, InSearchParameters.StartTime, InSearchParameters.EndTime, [this, &InSearchParameters, &FoundEvent](double StartTime, double EndTime, uint32 Row, int32 Index)
+			{
+				if (InSearchParameters.EventFilter && !InSearchParameters.EventFilter(StartTime, EndTime, Row))
+				{
+					return true;
+				}
+
+				FoundEvent = MakeShared<const FTimingEvent>(SharedThis(this), StartTime, EndTime, Row);
+				return false;
+			});
+	}
+
+	return FoundEvent;
+}
+
+/*******************************************************************************************/
+/*******************************  View Extender  *******************************************/
+/*******************************************************************************************/
+
+void FLockOnTargetTimingViewExtender::OnBeginSession(Insights::ITimingViewSession& InSession)
+{
+	SessionTracks.Add(&InSession);
+}
+
+void FLockOnTargetTimingViewExtender::OnEndSession(Insights::ITimingViewSession& InSession)
+{
+	if (TMap<uint32, TSharedPtr<FLockOnTargetTimingTrack>>* const Tracks = SessionTracks.Find(&InSession))
+	{
+		for (const TPair<uint32, TSharedPtr<FLockOnTargetTimingTrack>>& Track : *Tracks)
+		{
+			InSession.RemoveScrollableTrack(Track.Value);
+		}
+	}
+
+	SessionTracks.Remove(&InSession);
+}
+
+void FLockOnTargetTimingViewExtender::Tick(Insights::ITimingViewSession& InSession, const TraceServices::IAnalysisSession& InAnalysisSession)
+{
+	TMap<uint32, TSharedPtr<FLockOnTargetTimingTrack>>* const Tracks = SessionTracks.Find(&InSession);
+
+	if (!Tracks)
+	{
+		return;
+	}
+
+	TraceServices::FAnalysisSessionReadScope SessionReadScope(InAnalysisSession);
+
+	const FLockOnTargetTraceProvider* const Provider = InAnalysisSession.ReadProvider<FLockOnTargetTraceProvider>(FLockOnTargetTraceProvider::ProviderName);
+
+	if (!Provider)
+	{
+		return;
+	}
+
+	Provider->EnumerateTimelines([&InSession, &InAnalysisSession, Tracks](const FLockOnTargetTimeline& Timeline)
+		{
+			//The instigator name becomes known with the first Target event.
+			const FString TrackName = FString::Printf(TEXT("LockOnTarget - %s"), Timeline.Name);
+
+			if (const TSharedPtr<FLockOnTargetTimingTrack>* const Track = Tracks->Find(Timeline.InstigatorId))
+			{
+				if ((*Track)->GetName() != TrackName)
+				{
+					(*Track)->SetName(TrackName);
+				}
+			}
+			else
+			{
+				TSharedPtr<FLockOnTargetTimingTrack> NewTrack = MakeShared<FLockOnTargetTimingTrack>(InAnalysisSession, Timeline.InstigatorId, TrackName);
+				InSession.AddScrollableTrack(NewTrack);
+				Tracks->Add(Timeline.InstigatorId, NewTrack);
+			}
+		});
+}
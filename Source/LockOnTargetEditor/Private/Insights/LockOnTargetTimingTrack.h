@@ -0,0 +1,70 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Insights/ITimingViewExtender.h"
+#include "Insights/ViewModels/TimingEventsTrack.h"
+
+struct FLockOnTargetTimeline;
+
+namespace TraceServices
+{
+	class IAnalysisSession;
+}
+
+/**
+ * Timing Insights track with the lock on timeline of a single instigator.
+ * Rows: locked Targets, searches, Line of Sight timer, Line of Sight traces per frame.
+ */
+class FLockOnTargetTimingTrack : public FTimingEventsTrack
+{
+	INSIGHTS_DECLARE_RTTI(FLockOnTargetTimingTrack, FTimingEventsTrack)
+
+public:
+
+	FLockOnTargetTimingTrack(const TraceServices::IAnalysisSession& InSession, uint32 InInstigatorId, const FString& InName);
+
+	uint32 GetInstigatorId() const { return InstigatorId; }
+
+	virtual void BuildDrawState(ITimingEventsTrackDrawStateBuilder& Builder, const ITimingTrackUpdateContext& Context) override;
+	virtual void InitTooltip(FTooltipDrawState& InOutTooltip, const ITimingEvent& InTooltipEvent) const override;
+	virtual const TSharedPtr<const ITimingEvent> SearchEvent(const FTimingEventSearchParameters& InSearchParameters) const override;
+
+private:
+
+	enum ERow : uint32
+	{
+		Row_Lock,
+		Row_Search,
+		Row_LineOfSightTimer,
+		Row_Traces,
+	};
+
+	//Callback returns false to stop the enumeration.
+	using FEventCallback = TFunctionRef<bool(double /*StartTime*/, double /*EndTime*/, uint32 /*Row*/, int32 /*Index*/)>;
+
+	//Enumerates events of all rows intersecting the time range. Must be called within the session read scope.
+	void EnumerateEvents(const FLockOnTargetTimeline& Timeline, double StartTime, double EndTime, FEventCallback Callback) const;
+
+	const FLockOnTargetTimeline* ReadTimeline() const;
+
+	const TraceServices::IAnalysisSession& Session;
+	uint32 InstigatorId;
+};
+
+/**
+ * Adds a FLockOnTargetTimingTrack for each instigator found in the analysis session.
+ */
+class FLockOnTargetTimingViewExtender : public Insights::ITimingViewExtender
+{
+public:
+
+	virtual void OnBeginSession(Insights::ITimingViewSession& InSession) override;
+	virtual void OnEndSession(Insights::ITimingViewSession& InSession) override;
+	virtual void Tick(Insights::ITimingViewSession& InSession, const TraceServices::IAnalysisSession& InAnalysisSession) override;
+
+private:
+
+	TMap<Insights::ITimingViewSession*, TMap<uint32, TSharedPtr<FLockOnTargetTimingTrack>>> SessionTracks;
+};
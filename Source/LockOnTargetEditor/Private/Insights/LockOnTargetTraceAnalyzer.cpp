@@ -0,0 +1,75 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "Insights/LockOnTargetTraceAnalyzer.h"
+#include "Insights/LockOnTargetTraceProvider.h"
+
+#include "TraceServices/Model/AnalysisSession.h"
+
+FLockOnTargetTraceAnalyzer::FLockOnTargetTraceAnalyzer(TraceServices::IAnalysisSession& InSession, FLockOnTargetTraceProvider& InProvider)
+	: Session(InSession)
+	, Provider(InProvider)
+{
+}
+
+void FLockOnTargetTraceAnalyzer::OnAnalysisBegin(const FOnAnalysisContext& Context)
+{
+	auto& Builder = Context.InterfaceBuilder;
+
+	Builder.RouteEvent(RouteId_TargetEvent, "LockOnTarget", "TargetEvent");
+	Builder.RouteEvent(RouteId_Search, "LockOnTarget", "Search");
+	Builder.RouteEvent(RouteId_LineOfSightTraces, "LockOnTarget", "LineOfSightTraces");
+	Builder.RouteEvent(RouteId_LineOfSightTimer, "LockOnTarget", "LineOfSightTimer");
+}
+
+bool FLockOnTargetTraceAnalyzer::OnEvent(uint16 RouteId, EStyle Style, const FOnEventContext& Context)
+{
+	TraceServices::FAnalysisSessionEditScope _(Session);
+
+	const auto& EventData = Context.EventData;
+
+	switch (RouteId)
+	{
+	case RouteId_TargetEvent:
+	{
+		const double Time = Context.EventTime.AsSeconds(EventData.GetValue<uint64>("Cycle"));
+
+		FString InstigatorName, TargetName, Socket;
+		EventData.GetString("InstigatorName", InstigatorName);
+		EventData.GetString("TargetName", TargetName);
+		EventData.GetString("Socket", Socket);
+
+		Provider.AppendTargetEvent(EventData.GetValue<uint32>("InstigatorId"), Time, EventData.GetValue<uint8>("Event"), *InstigatorName, *TargetName, *Socket);
+		Session.UpdateDurationSeconds(Time);
+		break;
+	}
+	case RouteId_Search:
+	{
+		const double StartTime = Context.EventTime.AsSeconds(EventData.GetValue<uint64>("StartCycle"));
+		const double EndTime = Context.EventTime.AsSeconds(EventData.GetValue<uint64>("EndCycle"));
+
+		Provider.AppendSearch(EventData.GetValue<uint32>("InstigatorId"), StartTime, EndTime, EventData.GetValue<int32>("NumCandidates"), EventData.GetValue<int32>("NumTraces"), EventData.GetValue<bool>("bFound"));
+		Session.UpdateDurationSeconds(EndTime);
+		break;
+	}
+	case RouteId_LineOfSightTraces:
+	{
+		const double Time = Context.EventTime.AsSeconds(EventData.GetValue<uint64>("Cycle"));
+
+		Provider.AppendLineOfSightTraces(EventData.GetValue<uint32>("InstigatorId"), Time, EventData.GetValue<uint64>("FrameNumber"), EventData.GetValue<int32>("NumTraces"));
+		Session.UpdateDurationSeconds(Time);
+		break;
+	}
+	case RouteId_LineOfSightTimer:
+	{
+		const double Time = Context.EventTime.AsSeconds(EventData.GetValue<uint64>("Cycle"));
+
+		Provider.AppendLineOfSightTimer(EventData.GetValue<uint32>("InstigatorId"), Time, EventData.GetValue<bool>("bActive"));
+		Session.UpdateDurationSeconds(Time);
+		break;
+	}
+	default:
+		break;
+	}
+
+	return true;
+}
@@ -0,0 +1,40 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Analyzer.h"
+
+class FLockOnTargetTraceProvider;
+
+namespace TraceServices
+{
+	class IAnalysisSession;
+}
+
+/**
+ * Decodes LockOnTarget trace events (see LockOnTargetTrace.h) into FLockOnTargetTraceProvider.
+ */
+class FLockOnTargetTraceAnalyzer : public UE::Trace::IAnalyzer
+{
+public:
+
+	FLockOnTargetTraceAnalyzer(TraceServices::IAnalysisSession& InSession, FLockOnTargetTraceProvider& InProvider);
+
+	virtual void OnAnalysisBegin(const FOnAnalysisContext& Context) override;
+	virtual void OnAnalysisEnd() override {}
+	virtual bool OnEvent(uint16 RouteId, EStyle Style, const FOnEventContext& Context) override;
+
+private:
+
+	enum : uint16
+	{
+		RouteId_TargetEvent,
+		RouteId_Search,
+		RouteId_LineOfSightTraces,
+		RouteId_LineOfSightTimer,
+	};
+
+	TraceServices::IAnalysisSession& Session;
+	FLockOnTargetTraceProvider& Provider;
+};
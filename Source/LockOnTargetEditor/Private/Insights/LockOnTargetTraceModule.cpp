@@ -0,0 +1,27 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "Insights/LockOnTargetTraceModule.h"
+#include "Insights/LockOnTargetTraceAnalyzer.h"
+#include "Insights/LockOnTargetTraceProvider.h"
+
+#include "TraceServices/Model/AnalysisSession.h"
+
+const FName FLockOnTargetTraceModule::ModuleName(TEXT("LockOnTargetTrace"));
+
+void FLockOnTargetTraceModule::GetModuleInfo(TraceServices::FModuleInfo& OutModuleInfo)
+{
+	OutModuleInfo.Name = ModuleName;
+	OutModuleInfo.DisplayName = TEXT("LockOnTarget");
+}
+
+void FLockOnTargetTraceModule::OnAnalysisBegin(TraceServices::IAnalysisSession& InSession)
+{
+	TSharedPtr<FLockOnTargetTraceProvider> Provider = MakeShared<FLockOnTargetTraceProvider>(InSession);
+	InSession.AddProvider(FLockOnTargetTraceProvider::ProviderName, Provider);
+	InSession.AddAnalyzer(new FLockOnTargetTraceAnalyzer(InSession, *Provider));
+}
+
+void FLockOnTargetTraceModule::GetLoggers(TArray<const TCHAR*>& OutLoggers)
+{
+	OutLoggers.Add(TEXT("LockOnTarget"));
+}
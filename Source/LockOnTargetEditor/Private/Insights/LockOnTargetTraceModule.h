@@ -0,0 +1,22 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TraceServices/ModuleService.h"
+
+/**
+ * Registers the LockOnTarget analyzer and provider in each analysis session.
+ * Ref: GameplayInsights FGameplayTraceModule.
+ */
+class FLockOnTargetTraceModule : public TraceServices::IModule
+{
+public:
+
+	static const FName ModuleName;
+
+	virtual void GetModuleInfo(TraceServices::FModuleInfo& OutModuleInfo) override;
+	virtual void OnAnalysisBegin(TraceServices::IAnalysisSession& InSession) override;
+	virtual void GetLoggers(TArray<const TCHAR*>& OutLoggers) override;
+	virtual void GenerateReports(const TraceServices::IAnalysisSession& Session, const TCHAR* CmdLine, const TCHAR* OutputDirectory) override {}
+};
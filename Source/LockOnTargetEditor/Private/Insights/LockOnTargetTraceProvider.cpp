@@ -0,0 +1,130 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "Insights/LockOnTargetTraceProvider.h"
+#include "LockOnTargetTrace.h"
+
+#include "Algo/BinarySearch.h"
+
+const FName FLockOnTargetTraceProvider::ProviderName(TEXT("LockOnTargetTraceProvider"));
+
+FLockOnTargetTraceProvider::FLockOnTargetTraceProvider(TraceServices::IAnalysisSession& InSession)
+	: Session(InSession)
+{
+}
+
+FLockOnTargetTimeline& FLockOnTargetTraceProvider::GetOrAddTimeline(uint32 InstigatorId)
+{
+	if (const int32* const Index = TimelineIndices.Find(InstigatorId))
+	{
+		return *Timelines[*Index];
+	}
+
+	FLockOnTargetTimeline& Timeline = *Timelines.Add_GetRef(MakeUnique<FLockOnTargetTimeline>());
+	Timeline.InstigatorId = InstigatorId;
+	Timeline.Name = Session.StoreString(*FString::Printf(TEXT("Instigator %u"), InstigatorId));
+	TimelineIndices.Add(InstigatorId, Timelines.Num() - 1);
+
+	return Timeline;
+}
+
+/*******************************************************************************************/
+/*******************************  Analysis  ************************************************/
+/*******************************************************************************************/
+
+void FLockOnTargetTraceProvider::AppendTargetEvent(uint32 InstigatorId, double Time, uint8 Event, const TCHAR* InstigatorName, const TCHAR* TargetName, const TCHAR* Socket)
+{
+	Session.WriteAccessCheck();
+
+	FLockOnTargetTimeline& Timeline = GetOrAddTimeline(InstigatorId);
+
+	//The name is only known after the first Target event.
+	Timeline.Name = Session.StoreString(InstigatorName);
+
+	if (Timeline.LockSpans.Num() > 0 && Timeline.LockSpans.Last().EndTime > Time)
+	{
+		FLockOnTargetTimeline::FLockSpan& LastSpan = Timeline.LockSpans.Last();
+		LastSpan.EndTime = Time;
+		Timeline.MaxLockSpanDuration = FMath::Max(Timeline.MaxLockSpanDuration, LastSpan.EndTime - LastSpan.StartTime);
+	}
+
+	//A Socket change closes the current span and opens a new one for the same Target.
+	if (Event != static_cast<uint8>(ELockOnTargetTraceEvent::Unlocked))
+	{
+		FLockOnTargetTimeline::FLockSpan& Span = Timeline.LockSpans.AddDefaulted_GetRef();
+		Span.StartTime = Time;
+		Span.TargetName = Session.StoreString(TargetName);
+		Span.Socket = Session.StoreString(Socket);
+	}
+}
+
+void FLockOnTargetTraceProvider::AppendSearch(uint32 InstigatorId, double StartTime, double EndTime, int32 NumCandidates, int32 NumTraces, bool bFound)
+{
+	Session.WriteAccessCheck();
+
+	//Searches are traced when they end, so nested searches might come out of order.
+	FLockOnTargetTimeline& Timeline = GetOrAddTimeline(InstigatorId);
+	const int32 Index = Algo::UpperBoundBy(Timeline.Searches, StartTime, &FLockOnTargetTimeline::FSearch::StartTime);
+	Timeline.Searches.Insert({ StartTime, EndTime, NumCandidates, NumTraces, bFound }, Index);
+	Timeline.MaxSearchDuration = FMath::Max(Timeline.MaxSearchDuration, EndTime - StartTime);
+}
+
+void FLockOnTargetTraceProvider::AppendLineOfSightTraces(uint32 InstigatorId, double Time, uint64 FrameNumber, int32 NumTraces)
+{
+	Session.WriteAccessCheck();
+
+	FLockOnTargetTimeline& Timeline = GetOrAddTimeline(InstigatorId);
+	TArray<FLockOnTargetTimeline::FFrameTraces>& Traces = Timeline.Traces;
+
+	if (Traces.Num() > 0 && Traces.Last().FrameNumber == FrameNumber)
+	{
+		FLockOnTargetTimeline::FFrameTraces& LastTraces = Traces.Last();
+		LastTraces.EndTime = Time;
+		LastTraces.NumTraces += NumTraces;
+		Timeline.MaxTracesDuration = FMath::Max(Timeline.MaxTracesDuration, LastTraces.EndTime - LastTraces.StartTime);
+	}
+	else
+	{
+		Traces.Add({ FrameNumber, Time, Time, NumTraces });
+	}
+}
+
+void FLockOnTargetTraceProvider::AppendLineOfSightTimer(uint32 InstigatorId, double Time, bool bActive)
+{
+	Session.WriteAccessCheck();
+
+	FLockOnTargetTimeline& Timeline = GetOrAddTimeline(InstigatorId);
+	TArray<FLockOnTargetTimeline::FTimerSpan>& Timers = Timeline.LineOfSightTimers;
+	const bool bIsOpen = Timers.Num() > 0 && Timers.Last().EndTime > Time;
+
+	if (bActive && !bIsOpen)
+	{
+		Timers.AddDefaulted_GetRef().StartTime = Time;
+	}
+	else if (!bActive && bIsOpen)
+	{
+		Timers.Last().EndTime = Time;
+		Timeline.MaxLineOfSightTimerDuration = FMath::Max(Timeline.MaxLineOfSightTimerDuration, Time - Timers.Last().StartTime);
+	}
+}
+
+/*******************************************************************************************/
+/*******************************  Reading  *************************************************/
+/*******************************************************************************************/
+
+const FLockOnTargetTimeline* FLockOnTargetTraceProvider::FindTimeline(uint32 InstigatorId) const
+{
+	Session.ReadAccessCheck();
+
+	const int32* const Index = TimelineIndices.Find(InstigatorId);
+	return Index ? Timelines[*Index].Get() : nullptr;
+}
+
+void FLockOnTargetTraceProvider::EnumerateTimelines(TFunctionRef<void(const FLockOnTargetTimeline&)> Callback) const
+{
+	Session.ReadAccessCheck();
+
+	for (const TUniquePtr<FLockOnTargetTimeline>& Timeline : Timelines)
+	{
+		Callback(*Timeline);
+	}
+}
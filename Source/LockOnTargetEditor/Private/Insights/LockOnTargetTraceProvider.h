@@ -0,0 +1,94 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TraceServices/Model/AnalysisSession.h"
+
+/**
+ * Lock on timeline of a single LockOnTargetComponent decoded from the trace.
+ * Open spans have an infinite EndTime.
+ */
+struct FLockOnTargetTimeline
+{
+	struct FLockSpan
+	{
+		double StartTime = 0.0;
+		double EndTime = TNumericLimits<double>::Max();
+		const TCHAR* TargetName = nullptr;
+		const TCHAR* Socket = nullptr;
+	};
+
+	struct FSearch
+	{
+		double StartTime = 0.0;
+		double EndTime = 0.0;
+		int32 NumCandidates = 0;
+		int32 NumTraces = 0;
+		bool bFound = false;
+	};
+
+	struct FFrameTraces
+	{
+		uint64 FrameNumber = 0;
+		double StartTime = 0.0;
+		double EndTime = 0.0;
+		int32 NumTraces = 0;
+	};
+
+	struct FTimerSpan
+	{
+		double StartTime = 0.0;
+		double EndTime = TNumericLimits<double>::Max();
+	};
+
+	uint32 InstigatorId = 0;
+	const TCHAR* Name = nullptr;
+
+	//All arrays are sorted by the start time.
+	TArray<FLockSpan> LockSpans;
+	TArray<FSearch> Searches;
+	TArray<FFrameTraces> Traces;
+	TArray<FTimerSpan> LineOfSightTimers;
+
+	//The longest closed item of each row. Any item overlapping a time starts at most this long before it.
+	double MaxLockSpanDuration = 0.0;
+	double MaxSearchDuration = 0.0;
+	double MaxTracesDuration = 0.0;
+	double MaxLineOfSightTimerDuration = 0.0;
+};
+
+/**
+ * Holds lock on timelines of all instigators in the analysis session.
+ * Written by FLockOnTargetTraceAnalyzer within the session edit scope, read by the timing track within the read scope.
+ */
+class FLockOnTargetTraceProvider : public TraceServices::IProvider
+{
+public:
+
+	static const FName ProviderName;
+
+	explicit FLockOnTargetTraceProvider(TraceServices::IAnalysisSession& InSession);
+
+public: /** Analysis */
+
+	void AppendTargetEvent(uint32 InstigatorId, double Time, uint8 Event, const TCHAR* InstigatorName, const TCHAR* TargetName, const TCHAR* Socket);
+	void AppendSearch(uint32 InstigatorId, double StartTime, double EndTime, int32 NumCandidates, int32 NumTraces, bool bFound);
+	void AppendLineOfSightTraces(uint32 InstigatorId, double Time, uint64 FrameNumber, int32 NumTraces);
+	void AppendLineOfSightTimer(uint32 InstigatorId, double Time, bool bActive);
+
+public: /** Reading */
+
+	const FLockOnTargetTimeline* FindTimeline(uint32 InstigatorId) const;
+	void EnumerateTimelines(TFunctionRef<void(const FLockOnTargetTimeline&)> Callback) const;
+
+private:
+
+	FLockOnTargetTimeline& GetOrAddTimeline(uint32 InstigatorId);
+
+	TraceServices::IAnalysisSession& Session;
+
+	//Timelines are heap allocated to keep them stable while new instigators appear.
+	TArray<TUniquePtr<FLockOnTargetTimeline>> Timelines;
+	TMap<uint32, int32> TimelineIndices;
+};
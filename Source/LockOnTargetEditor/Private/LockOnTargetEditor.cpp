@@ -11,6 +11,7 @@
 #include "LockOnComponentDetails.h"
 #include "TargetComponentDetails.h"
 #include "Editor/UnrealEdEngine.h"
+#include "Features/IModularFeatures.h"
 
 DEFINE_LOG_CATEGORY(LogLockOnTargetEditor);
 
@@ -27,6 +28,9 @@ void FLockOnTargetEditorModule::StartupModule()
 	FPropertyEditorModule& PropertyModule = FModuleManager::LoadModuleChecked<FPropertyEditorModule>(TEXT("PropertyEditor"));
 	PropertyModule.RegisterCustomClassLayout(ULockOnTargetComponent::StaticClass()->GetFName(), FOnGetDetailCustomizationInstance::CreateStatic(&FLockOnComponentDetails::MakeInstance));
 	PropertyModule.RegisterCustomClassLayout(UTargetComponent::StaticClass()->GetFName(), FOnGetDetailCustomizationInstance::CreateStatic(&FTargetComponentDetails::MakeInstance));
+
+	IModularFeatures::Get().RegisterModularFeature(TraceServices::ModuleFeatureName, &TraceModule);
+	IModularFeatures::Get().RegisterModularFeature(Insights::TimingViewExtenderFeatureName, &TimingViewExtender);
 }
 
 void FLockOnTargetEditorModule::ShutdownModule()
@@ -38,6 +42,9 @@ void FLockOnTargetEditorModule::ShutdownModule()
 	FPropertyEditorModule& PropertyModule = FModuleManager::GetModuleChecked<FPropertyEditorModule>(TEXT("PropertyEditor"));
 	PropertyModule.UnregisterCustomClassLayout(ULockOnTargetComponent::StaticClass()->GetFName());
 	PropertyModule.UnregisterCustomClassLayout(UTargetComponent::StaticClass()->GetFName());
+
+	IModularFeatures::Get().UnregisterModularFeature(TraceServices::ModuleFeatureName, &TraceModule);
+	IModularFeatures::Get().UnregisterModularFeature(Insights::TimingViewExtenderFeatureName, &TimingViewExtender);
 }
 
 #define IMAGE_BRUSH(RelativePath, ...) FSlateImageBrush(LockOnTargetStyleSet->RootToContentDir(RelativePath, TEXT(".png")), __VA_ARGS__)
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
+#include "Insights/LockOnTargetTraceModule.h"
+#include "Insights/LockOnTargetTimingTrack.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogLockOnTargetEditor, All, All);
 
@@ -21,4 +23,8 @@ private:
 	void RegisterStyles();
 	void UnregisterStyles();
 	TSharedPtr<FSlateStyleSet> LockOnTargetStyleSet;
+
+	//Insights extension.
+	FLockOnTargetTraceModule TraceModule;
+	FLockOnTargetTimingViewExtender TimingViewExtender;
 };
@@ -26,6 +26,7 @@
 #include "DetailCategoryBuilder.h"
 #include "DetailLayoutBuilder.h"
 #include "PropertyHandle.h"
+#include "ScopedTransaction.h"
 #include "IDetailPropertyRow.h"
 
 void FTargetComponentDetails::CustomizeDetails(IDetailLayoutBuilder& DetailLayout)
@@ -93,6 +94,9 @@ void FTargetComponentDetails::CustomizeDetails(IDetailLayoutBuilder& DetailLayou
 			auto DetailArrayBuilder = MakeShared<FDetailArrayBuilder>(SocketsPropertyHandle.ToSharedRef());
 			DetailArrayBuilder->OnGenerateArrayElementWidget(FOnGenerateArrayElementWidget::CreateSP(this, &FTargetComponentDetails::GenerateArrayElementWidget));
 			DefaultCategoryBuilder.AddCustomBuilder(DetailArrayBuilder);
+
+			SocketsPropertyHandle->SetOnPropertyValueChanged(FSimpleDelegate::CreateSP(this, &FTargetComponentDetails::BakeSockets));
+			SocketsPropertyHandle->SetOnChildPropertyValueChanged(FSimpleDelegate::CreateSP(this, &FTargetComponentDetails::BakeSockets));
 		}
 	}
 
@@ -113,6 +117,8 @@ void FTargetComponentDetails::CustomizeDetails(IDetailLayoutBuilder& DetailLayou
 
 		if (CustomSocketPropertyHandle->IsValidHandle())
 		{
+			CustomSocketPropertyHandle->SetOnPropertyValueChanged(FSimpleDelegate::CreateSP(this, &FTargetComponentDetails::BakeSockets));
+
 			FocusPointDetailBuilder.AddProperty(CustomSocketPropertyHandle).CustomWidget()
 				.NameContent()
 				[
@@ -191,6 +197,22 @@ USceneComponent* FTargetComponentDetails::GetTrackedMeshComponent() const
 void FTargetComponentDetails::UpdateMeshPropertyText()
 {
 	OnCommitMeshEntry(GetTrackedMeshName());
+	BakeSockets();
+}
+
+void FTargetComponentDetails::BakeSockets()
+{
+	//Gives immediate feedback about invalid Sockets. The final bake happens on save.
+	if (EditedComponent.IsValid())
+	{
+		if (const USceneComponent* const Mesh = GetTrackedMeshComponent())
+		{
+			//The baked data is serialized, so it has to be undoable along with the edited property.
+			const FScopedTransaction Transaction(FText::FromString(TEXT("Bake Target Sockets")));
+			EditedComponent->Modify();
+			EditedComponent->BakeSockets(Mesh);
+		}
+	}
 }
 
 void FTargetComponentDetails::OnCommitMeshEntry(FName MeshName)
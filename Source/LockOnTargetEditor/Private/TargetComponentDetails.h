@@ -32,6 +32,7 @@ private:
 	USceneComponent* GetTrackedMeshComponent() const;
 
 	void UpdateMeshPropertyText();
+	void BakeSockets();
 	void OnCommitMeshEntry(FName MeshName);
 	void OnCommitMeshText(const FText& ItemFText, ETextCommit::Type CommitInfo);
 
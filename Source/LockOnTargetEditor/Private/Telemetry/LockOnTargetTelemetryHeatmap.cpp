@@ -0,0 +1,173 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Engine/World.h"
+#include "DrawDebugHelpers.h"
+
+/**
+ * Overlays a telemetry file written by ULockOnTargetTelemetry on the level.
+ * Cells are drawn as persistent debug boxes colored from green (cheap) to red (the most expensive cell).
+ */
+
+DEFINE_LOG_CATEGORY_STATIC(LogLockOnTargetTelemetry, Log, All);
+
+static FString GetTelemetryDir()
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("LockOnTarget"), TEXT("Telemetry"));
+}
+
+//Finds the most recent file of the map.
+static FString FindLatestTelemetryFile(const FString& MapName)
+{
+	TArray<FString> FileNames;
+	IFileManager::Get().FindFiles(FileNames, *FPaths::Combine(GetTelemetryDir(), MapName + TEXT("_*.csv")), true, false);
+
+	FString LatestPath;
+	FDateTime LatestTime = FDateTime::MinValue();
+
+	for (const FString& FileName : FileNames)
+	{
+		const FString Path = FPaths::Combine(GetTelemetryDir(), FileName);
+		const FDateTime Time = IFileManager::Get().GetTimeStamp(*Path);
+
+		if (Time > LatestTime)
+		{
+			LatestTime = Time;
+			LatestPath = Path;
+		}
+	}
+
+	return LatestPath;
+}
+
+static double GetCellMetric(const TMap<FString, int32>& Columns, const TArray<FString>& Values, const FString& Metric)
+{
+	const auto Value = [&Columns, &Values](const TCHAR* Column)
+	{
+		const int32* const Index = Columns.Find(Column);
+		return Index && Values.IsValidIndex(*Index) ? FCString::Atod(*Values[*Index]) : 0.0;
+	};
+
+	if (Metric == TEXT("Search"))
+	{
+		return Value(TEXT("SearchTotalMs"));
+	}
+	else if (Metric == TEXT("Check"))
+	{
+		return Value(TEXT("CheckTotalMs"));
+	}
+	else if (Metric == TEXT("Max"))
+	{
+		return FMath::Max(Value(TEXT("SearchMaxMs")), Value(TEXT("CheckMaxMs")));
+	}
+	else if (Metric == TEXT("Candidates"))
+	{
+		const double Searches = Value(TEXT("Searches"));
+		return Searches > 0.0 ? Value(TEXT("Candidates")) / Searches : 0.0;
+	}
+	else if (Metric == TEXT("Traces"))
+	{
+		return Value(TEXT("Traces"));
+	}
+
+	return Value(TEXT("SearchTotalMs")) + Value(TEXT("CheckTotalMs"));
+}
+
+static void ShowTelemetryHeatmapCommand(const TArray<FString>& Args, UWorld* World)
+{
+	if (!World)
+	{
+		return;
+	}
+
+	//Usage: lot.ShowTelemetryHeatmap [File] [Metric] [Duration]
+	FString Path = Args.IsValidIndex(0) && Args[0] != TEXT("Latest") ? Args[0] : FindLatestTelemetryFile(World->RemovePIEPrefix(World->GetMapName()));
+	const FString Metric = Args.IsValidIndex(1) ? Args[1] : TEXT("Total");
+	const float Duration = Args.IsValidIndex(2) ? FCString::Atof(*Args[2]) : -1.f;
+
+	if (FPaths::IsRelative(Path) && !Path.IsEmpty())
+	{
+		Path = FPaths::Combine(GetTelemetryDir(), Path);
+	}
+
+	TArray<FString> Lines;
+
+	if (Path.IsEmpty() || !FFileHelper::LoadFileToStringArray(Lines, *Path) || Lines.Num() < 2)
+	{
+		UE_LOG(LogLockOnTargetTelemetry, Warning, TEXT("No LockOnTarget telemetry found at '%s'."), *Path);
+		return;
+	}
+
+	TMap<FString, int32> Columns;
+	TArray<FString> Header;
+	Lines[0].ParseIntoArray(Header, TEXT(","));
+
+	for (int32 i = 0; i < Header.Num(); ++i)
+	{
+		Columns.Add(Header[i], i);
+	}
+
+	struct FCell
+	{
+		FBox Box;
+		double Metric;
+	};
+
+	TArray<FCell> Cells;
+	Cells.Reserve(Lines.Num() - 1);
+	double MaxMetric = 0.0;
+
+	for (int32 i = 1; i < Lines.Num(); ++i)
+	{
+		TArray<FString> Values;
+
+		if (Lines[i].ParseIntoArray(Values, TEXT(",")) < Header.Num())
+		{
+			continue;
+		}
+
+		const auto Value = [&Columns, &Values](const TCHAR* Column) { return FCString::Atod(*Values[Columns.FindRef(Column)]); };
+		const double CellSize = Value(TEXT("MaxX")) - Value(TEXT("MinX"));
+		const double Z = Value(TEXT("Z"));
+
+		//Flat boxes slightly smaller than the cell to keep the borders visible.
+		const FBox Box(FVector(Value(TEXT("MinX")), Value(TEXT("MinY")), Z), FVector(Value(TEXT("MaxX")), Value(TEXT("MaxY")), Z + CellSize * 0.05));
+		FCell& Cell = Cells.Add_GetRef({ Box.ExpandBy(FVector(-CellSize * 0.02, -CellSize * 0.02, 0.0)), GetCellMetric(Columns, Values, Metric) });
+		MaxMetric = FMath::Max(MaxMetric, Cell.Metric);
+	}
+
+	FlushPersistentDebugLines(World);
+
+	for (const FCell& Cell : Cells)
+	{
+		const float Alpha = MaxMetric > 0.0 ? static_cast<float>(Cell.Metric / MaxMetric) : 0.f;
+		FLinearColor Color = FLinearColor::LerpUsingHSV(FLinearColor::Green, FLinearColor::Red, Alpha);
+		Color.A = 0.5f;
+
+		DrawDebugSolidBox(World, Cell.Box, Color.ToFColor(true), FTransform::Identity, Duration < 0.f, Duration);
+	}
+
+	UE_LOG(LogLockOnTargetTelemetry, Log, TEXT("Showing %d cells of '%s' by %s, max %.3f."), Cells.Num(), *Path, *Metric, MaxMetric);
+}
+
+static void ClearTelemetryHeatmapCommand(UWorld* World)
+{
+	if (World)
+	{
+		FlushPersistentDebugLines(World);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs ShowTelemetryHeatmapCmd(
+	TEXT("lot.ShowTelemetryHeatmap"),
+	TEXT("Overlays the LockOnTarget telemetry on the level. Usage: lot.ShowTelemetryHeatmap [File=Latest] [Metric=Total|Search|Check|Max|Candidates|Traces] [Duration=-1]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ShowTelemetryHeatmapCommand));
+
+static FAutoConsoleCommandWithWorld ClearTelemetryHeatmapCmd(
+	TEXT("lot.ClearTelemetryHeatmap"),
+	TEXT("Clears the heatmap drawn by lot.ShowTelemetryHeatmap."),
+	FConsoleCommandWithWorldDelegate::CreateStatic(&ClearTelemetryHeatmapCommand));
@@ -0,0 +1,30 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class LockOnTargetNiagara : ModuleRules
+{
+    public LockOnTargetNiagara(ReadOnlyTargetRules Target) : base(Target)
+    {
+        PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+        PublicDependencyModuleNames.AddRange(
+            new string[]
+            {
+                "Core",
+                "CoreUObject",
+                "Engine",
+                "Niagara",
+            }
+            );
+
+        PrivateDependencyModuleNames.AddRange(
+            new string[]
+            {
+                "LockOnTarget",
+                "NiagaraCore",
+                "VectorVM",
+            }
+            );
+    }
+}
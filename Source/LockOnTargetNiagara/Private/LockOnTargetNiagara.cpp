@@ -0,0 +1,5 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "Modules/ModuleManager.h"
+
+IMPLEMENT_MODULE(FDefaultModuleImpl, LockOnTargetNiagara);
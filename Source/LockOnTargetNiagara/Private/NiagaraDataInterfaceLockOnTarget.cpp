@@ -0,0 +1,337 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#include "NiagaraDataInterfaceLockOnTarget.h"
+#include "LockOnTargetComponent.h"
+#include "TargetComponent.h"
+#include "TargetHandlers/ThirdPersonTargetHandler.h"
+
+#include "NiagaraSystemInstance.h"
+#include "NiagaraTypes.h"
+#include "VectorVM.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+
+#define LOCTEXT_NAMESPACE "NiagaraDataInterfaceLockOnTarget"
+
+namespace NDILockOnTarget
+{
+	static const FName IsTargetLockedName(TEXT("IsTargetLocked"));
+	static const FName GetFocusLocationName(TEXT("GetFocusLocation"));
+	static const FName GetSocketLocationName(TEXT("GetSocketLocation"));
+	static const FName GetNumCandidatesName(TEXT("GetNumCandidates"));
+	static const FName GetCandidateLocationName(TEXT("GetCandidateLocation"));
+}
+
+/**
+ * Lock on state captured on the game thread for the simulation. Locations are in the simulation LWC tile space.
+ */
+struct FNDILockOnTargetInstanceData
+{
+	TWeakObjectPtr<ULockOnTargetComponent> Instigator;
+
+	bool bIsTargetLocked = false;
+	FVector3f FocusLocation = FVector3f::ZeroVector;
+	FVector3f SocketLocation = FVector3f::ZeroVector;
+	TArray<FVector3f> Candidates;
+};
+
+UNiagaraDataInterfaceLockOnTarget::UNiagaraDataInterfaceLockOnTarget(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+	, Source(ELockOnTargetNiagaraSource::AttachedActor)
+	, MaxCandidates(4)
+	, CandidateMaxAge(0.5f)
+{
+}
+
+void UNiagaraDataInterfaceLockOnTarget::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	if (HasAnyFlags(RF_ClassDefaultObject))
+	{
+		const ENiagaraTypeRegistryFlags Flags = ENiagaraTypeRegistryFlags::AllowAnyVariable | ENiagaraTypeRegistryFlags::AllowParameter;
+		FNiagaraTypeRegistry::Register(FNiagaraTypeDefinition(GetClass()), Flags);
+	}
+}
+
+/*******************************************************************************************/
+/*******************************  Functions  ***********************************************/
+/*******************************************************************************************/
+
+void UNiagaraDataInterfaceLockOnTarget::GetFunctions(TArray<FNiagaraFunctionSignature>& OutFunctions)
+{
+	using namespace NDILockOnTarget;
+
+	FNiagaraFunctionSignature DefaultSignature;
+	DefaultSignature.bMemberFunction = true;
+	DefaultSignature.bRequiresContext = false;
+	DefaultSignature.Inputs.Emplace(FNiagaraTypeDefinition(GetClass()), TEXT("LockOnTarget"));
+
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(DefaultSignature);
+		Signature.Name = IsTargetLockedName;
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetBoolDef(), TEXT("IsLocked"));
+#if WITH_EDITORONLY_DATA
+		Signature.SetDescription(LOCTEXT("IsTargetLockedDesc", "Whether the instigator has locked any Target."));
+#endif
+	}
+
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(DefaultSignature);
+		Signature.Name = GetFocusLocationName;
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetPositionDef(), TEXT("Location"));
+#if WITH_EDITORONLY_DATA
+		Signature.SetDescription(LOCTEXT("GetFocusLocationDesc", "FocusPoint location of the locked Target."));
+#endif
+	}
+
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(DefaultSignature);
+		Signature.Name = GetSocketLocationName;
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetPositionDef(), TEXT("Location"));
+#if WITH_EDITORONLY_DATA
+		Signature.SetDescription(LOCTEXT("GetSocketLocationDesc", "Location of the captured Socket of the locked Target."));
+#endif
+	}
+
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(DefaultSignature);
+		Signature.Name = GetNumCandidatesName;
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("Num"));
+#if WITH_EDITORONLY_DATA
+		Signature.SetDescription(LOCTEXT("GetNumCandidatesDesc", "Number of the candidates of the last Target search, the best first. The locked Target isn't a candidate."));
+#endif
+	}
+
+	{
+		FNiagaraFunctionSignature& Signature = OutFunctions.Add_GetRef(DefaultSignature);
+		Signature.Name = GetCandidateLocationName;
+		Signature.Inputs.Emplace(FNiagaraTypeDefinition::GetIntDef(), TEXT("Index"));
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetBoolDef(), TEXT("IsValid"));
+		Signature.Outputs.Emplace(FNiagaraTypeDefinition::GetPositionDef(), TEXT("Location"));
+#if WITH_EDITORONLY_DATA
+		Signature.SetDescription(LOCTEXT("GetCandidateLocationDesc", "Location of the best Socket of the candidate."));
+#endif
+	}
+}
+
+void UNiagaraDataInterfaceLockOnTarget::GetVMExternalFunction(const FVMExternalFunctionBindingInfo& BindingInfo, void* InstanceData, FVMExternalFunction& OutFunc)
+{
+	using namespace NDILockOnTarget;
+
+	if (BindingInfo.Name == IsTargetLockedName)
+	{
+		OutFunc = FVMExternalFunction::CreateUObject(this, &ThisClass::VMIsTargetLocked);
+	}
+	else if (BindingInfo.Name == GetFocusLocationName)
+	{
+		OutFunc = FVMExternalFunction::CreateUObject(this, &ThisClass::VMGetFocusLocation);
+	}
+	else if (BindingInfo.Name == GetSocketLocationName)
+	{
+		OutFunc = FVMExternalFunction::CreateUObject(this, &ThisClass::VMGetSocketLocation);
+	}
+	else if (BindingInfo.Name == GetNumCandidatesName)
+	{
+		OutFunc = FVMExternalFunction::CreateUObject(this, &ThisClass::VMGetNumCandidates);
+	}
+	else if (BindingInfo.Name == GetCandidateLocationName)
+	{
+		OutFunc = FVMExternalFunction::CreateUObject(this, &ThisClass::VMGetCandidateLocation);
+	}
+}
+
+/*******************************************************************************************/
+/*******************************  Instance Data  *******************************************/
+/*******************************************************************************************/
+
+int32 UNiagaraDataInterfaceLockOnTarget::PerInstanceDataSize() const
+{
+	return sizeof(FNDILockOnTargetInstanceData);
+}
+
+bool UNiagaraDataInterfaceLockOnTarget::InitPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance)
+{
+	new (PerInstanceData) FNDILockOnTargetInstanceData();
+	return true;
+}
+
+void UNiagaraDataInterfaceLockOnTarget::DestroyPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance)
+{
+	static_cast<FNDILockOnTargetInstanceData*>(PerInstanceData)->~FNDILockOnTargetInstanceData();
+}
+
+static ULockOnTargetComponent* FindInstigator(ELockOnTargetNiagaraSource Source, FNiagaraSystemInstance* SystemInstance)
+{
+	const AActor* Owner = nullptr;
+
+	if (Source == ELockOnTargetNiagaraSource::AttachedActor)
+	{
+		const USceneComponent* const AttachComponent = SystemInstance->GetAttachComponent();
+		Owner = AttachComponent ? AttachComponent->GetOwner() : nullptr;
+	}
+	else if (const UWorld* const World = SystemInstance->GetWorld())
+	{
+		const APlayerController* const PlayerController = World->GetFirstPlayerController();
+		Owner = PlayerController ? PlayerController->GetPawn() : nullptr;
+	}
+
+	return Owner ? Owner->FindComponentByClass<ULockOnTargetComponent>() : nullptr;
+}
+
+bool UNiagaraDataInterfaceLockOnTarget::PerInstanceTick(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance, float DeltaSeconds)
+{
+	FNDILockOnTargetInstanceData& InstanceData = *static_cast<FNDILockOnTargetInstanceData*>(PerInstanceData);
+
+	ULockOnTargetComponent* Instigator = InstanceData.Instigator.Get();
+
+	//The pawn may be possessed or the component added after the system has been activated.
+	if (!Instigator)
+	{
+		Instigator = FindInstigator(Source, SystemInstance);
+		InstanceData.Instigator = Instigator;
+	}
+
+	InstanceData.bIsTargetLocked = false;
+
+	if (!Instigator)
+	{
+		InstanceData.Candidates.Reset();
+		return false;
+	}
+
+	const FVector TileOffset = FVector(SystemInstance->GetLWCTile()) * FLargeWorldRenderScalar::GetTileSize();
+
+	if (Instigator->IsTargetLocked())
+	{
+		InstanceData.bIsTargetLocked = true;
+		InstanceData.FocusLocation = FVector3f(Instigator->GetCapturedFocusLocation() - TileOffset);
+		InstanceData.SocketLocation = FVector3f(Instigator->GetCapturedSocketLocation() - TileOffset);
+	}
+
+	InstanceData.Candidates.Reset();
+
+	//No search is made for the simulation. The candidates come from the last search of the handler, e.g. made by UTargetPreviewModule.
+	const UThirdPersonTargetHandler* const Handler = Cast<UThirdPersonTargetHandler>(Instigator->GetTargetHandler());
+
+	if (MaxCandidates > 0 && Handler && (CandidateMaxAge <= 0.f || Handler->GetWorld()->TimeSince(Handler->GetLastCandidatesTime()) <= CandidateMaxAge))
+	{
+		//Candidates are Sockets, so only the best one of each Target is taken.
+		TArray<const UTargetComponent*, TInlineAllocator<8>> AddedTargets;
+
+		for (const FTargetInfo& Candidate : Handler->GetLastCandidates())
+		{
+			const UTargetComponent* const Target = Candidate.TargetComponent;
+
+			if (IsValid(Target) && Target != Instigator->GetTargetComponent() && Target->IsSocketValid(Candidate.Socket) && !AddedTargets.Contains(Target))
+			{
+				AddedTargets.Add(Target);
+				InstanceData.Candidates.Add(FVector3f(Target->GetSocketLocation(Candidate.Socket) - TileOffset));
+
+				if (InstanceData.Candidates.Num() >= MaxCandidates)
+				{
+					break;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+bool UNiagaraDataInterfaceLockOnTarget::Equals(const UNiagaraDataInterface* Other) const
+{
+	if (!Super::Equals(Other))
+	{
+		return false;
+	}
+
+	const ThisClass* const OtherTyped = CastChecked<const ThisClass>(Other);
+
+	return OtherTyped->Source == Source
+		&& OtherTyped->MaxCandidates == MaxCandidates
+		&& OtherTyped->CandidateMaxAge == CandidateMaxAge;
+}
+
+bool UNiagaraDataInterfaceLockOnTarget::CopyToInternal(UNiagaraDataInterface* Destination) const
+{
+	if (!Super::CopyToInternal(Destination))
+	{
+		return false;
+	}
+
+	ThisClass* const DestinationTyped = CastChecked<ThisClass>(Destination);
+	DestinationTyped->Source = Source;
+	DestinationTyped->MaxCandidates = MaxCandidates;
+	DestinationTyped->CandidateMaxAge = CandidateMaxAge;
+
+	return true;
+}
+
+/*******************************************************************************************/
+/*******************************  VM  ******************************************************/
+/*******************************************************************************************/
+
+void UNiagaraDataInterfaceLockOnTarget::VMIsTargetLocked(FVectorVMExternalFunctionContext& Context)
+{
+	VectorVM::FUserPtrHandler<FNDILockOnTargetInstanceData> InstanceData(Context);
+	FNDIOutputParam<bool> OutIsLocked(Context);
+
+	for (int32 i = 0; i < Context.GetNumInstances(); ++i)
+	{
+		OutIsLocked.SetAndAdvance(InstanceData->bIsTargetLocked);
+	}
+}
+
+void UNiagaraDataInterfaceLockOnTarget::VMGetFocusLocation(FVectorVMExternalFunctionContext& Context)
+{
+	VectorVM::FUserPtrHandler<FNDILockOnTargetInstanceData> InstanceData(Context);
+	FNDIOutputParam<FVector3f> OutLocation(Context);
+
+	for (int32 i = 0; i < Context.GetNumInstances(); ++i)
+	{
+		OutLocation.SetAndAdvance(InstanceData->FocusLocation);
+	}
+}
+
+void UNiagaraDataInterfaceLockOnTarget::VMGetSocketLocation(FVectorVMExternalFunctionContext& Context)
+{
+	VectorVM::FUserPtrHandler<FNDILockOnTargetInstanceData> InstanceData(Context);
+	FNDIOutputParam<FVector3f> OutLocation(Context);
+
+	for (int32 i = 0; i < Context.GetNumInstances(); ++i)
+	{
+		OutLocation.SetAndAdvance(InstanceData->SocketLocation);
+	}
+}
+
+void UNiagaraDataInterfaceLockOnTarget::VMGetNumCandidates(FVectorVMExternalFunctionContext& Context)
+{
+	VectorVM::FUserPtrHandler<FNDILockOnTargetInstanceData> InstanceData(Context);
+	FNDIOutputParam<int32> OutNum(Context);
+
+	for (int32 i = 0; i < Context.GetNumInstances(); ++i)
+	{
+		OutNum.SetAndAdvance(InstanceData->Candidates.Num());
+	}
+}
+
+void UNiagaraDataInterfaceLockOnTarget::VMGetCandidateLocation(FVectorVMExternalFunctionContext& Context)
+{
+	VectorVM::FUserPtrHandler<FNDILockOnTargetInstanceData> InstanceData(Context);
+	FNDIInputParam<int32> InIndex(Context);
+	FNDIOutputParam<bool> OutIsValid(Context);
+	FNDIOutputParam<FVector3f> OutLocation(Context);
+
+	for (int32 i = 0; i < Context.GetNumInstances(); ++i)
+	{
+		const int32 Index = InIndex.GetAndAdvance();
+		const bool bIsValid = InstanceData->Candidates.IsValidIndex(Index);
+
+		OutIsValid.SetAndAdvance(bIsValid);
+		OutLocation.SetAndAdvance(bIsValid ? InstanceData->Candidates[Index] : FVector3f::ZeroVector);
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,72 @@
+// Copyright 2022-2023 Ivan Baktenkov. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NiagaraDataInterface.h"
+#include "NiagaraDataInterfaceLockOnTarget.generated.h"
+
+class ULockOnTargetComponent;
+
+/** Where the data interface looks for the ULockOnTargetComponent. */
+UENUM()
+enum class ELockOnTargetNiagaraSource : uint8
+{
+	AttachedActor	UMETA(ToolTip = "The owner of the component the system is attached to."),
+	LocalPlayer		UMETA(ToolTip = "The pawn of the first local player.")
+};
+
+/**
+ * Exposes the lock on state of an instigator to Niagara CPU simulations.
+ * The state is read once per system instance tick, so no parameters have to be pushed from Blueprint.
+ */
+UCLASS(EditInlineNew, Category = "LockOnTarget", meta = (DisplayName = "Lock On Target"))
+class LOCKONTARGETNIAGARA_API UNiagaraDataInterfaceLockOnTarget : public UNiagaraDataInterface
+{
+	GENERATED_UCLASS_BODY()
+
+public: /** Config */
+
+	/** Where to look for the ULockOnTargetComponent. */
+	UPROPERTY(EditAnywhere, Category = "LockOnTarget")
+	ELockOnTargetNiagaraSource Source;
+
+	/**
+	 * The maximum number of candidates. 0 disables the candidates.
+	 * Candidates are read from the last Target search of UThirdPersonTargetHandler, e.g. made by UTargetPreviewModule, so nothing is searched for the system.
+	 */
+	UPROPERTY(EditAnywhere, Category = "LockOnTarget|Candidates", meta = (ClampMin = 0, UIMin = 0, UIMax = 32))
+	int32 MaxCandidates;
+
+	/** Candidates of an older search are dropped, e.g. while the Target is locked and the preview is off. 0 keeps them until the next search. */
+	UPROPERTY(EditAnywhere, Category = "LockOnTarget|Candidates", meta = (ClampMin = 0.f, UIMin = 0.f, Units = "s"))
+	float CandidateMaxAge;
+
+public: /** Overrides */
+
+	//UObject
+	virtual void PostInitProperties() override;
+
+	//UNiagaraDataInterface
+	virtual void GetFunctions(TArray<FNiagaraFunctionSignature>& OutFunctions) override;
+	virtual void GetVMExternalFunction(const FVMExternalFunctionBindingInfo& BindingInfo, void* InstanceData, FVMExternalFunction& OutFunc) override;
+	virtual bool CanExecuteOnTarget(ENiagaraSimTarget Target) const override { return Target == ENiagaraSimTarget::CPUSim; }
+	virtual int32 PerInstanceDataSize() const override;
+	virtual bool InitPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance) override;
+	virtual void DestroyPerInstanceData(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance) override;
+	virtual bool PerInstanceTick(void* PerInstanceData, FNiagaraSystemInstance* SystemInstance, float DeltaSeconds) override;
+	virtual bool HasPreSimulateTick() const override { return true; }
+	virtual bool Equals(const UNiagaraDataInterface* Other) const override;
+
+protected:
+
+	virtual bool CopyToInternal(UNiagaraDataInterface* Destination) const override;
+
+private: /** VM */
+
+	void VMIsTargetLocked(FVectorVMExternalFunctionContext& Context);
+	void VMGetFocusLocation(FVectorVMExternalFunctionContext& Context);
+	void VMGetSocketLocation(FVectorVMExternalFunctionContext& Context);
+	void VMGetNumCandidates(FVectorVMExternalFunctionContext& Context);
+	void VMGetCandidateLocation(FVectorVMExternalFunctionContext& Context);
+};